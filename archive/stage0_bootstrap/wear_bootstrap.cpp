@@ -10,27 +10,62 @@
  * - While loops (selama/while)
  * - If/Else statements (jika/lainnya)
  * - Function declarations (fungsi/function)
+ * - Type annotations on parameters and return values (int/teks)
+ * - Whole-program type inference with one C clone per argument signature
+ * - Inlining of small functions (automatic, or forced with @sisip)
+ * - Modules (impor "file.wr"), read and lexed in parallel, with unused
+ *   functions/constants/imports removed
+ * - Loop-invariant hoisting and reuse of repeated pure calls
+ * - Self tail calls compiled to loops (--report-tail-calls lists them)
+ * - Compile-time evaluation of pure calls with literal arguments
+ * - Memoized functions (@ingat / @ingat(max_entries), --memo-stats)
+ * - Strings grown in loops ('s = s + x') are built in place, not recopied
+ * - Character-scanning loops mapped to span/memchr runtime primitives
+ * - Arrays ([1, 2], a[i]) and zero-copy substring views (potong/pisah)
+ * - Regular expressions (cocok(s, /pattern/)) compiled to DFA tables
+ * - Parallel sorting of arrays (urutkan) on a runtime thread pool
+ * - Parallel loops (paralel (i dari a sampai b)) outlined onto the pool
+ * - Tasks (jalankan f(x) / tunggu t) on a work-stealing scheduler
+ * - Generators (hasilkan x, iterated with untuk (x dari f(a))) compiled to state machines
+ * - Bounded lock-free channels (saluran, kirim/terima, coba_kirim/coba_terima, tutup)
+ * - Atomic ints (atomik) and paralel reductions (kurangi(+: total))
+ * - Independent counted selama loops run in parallel (--auto-paralel)
+ * - Int array builtins (jumlah, maks, min, hitung_jika, tambah_semua/kali_semua)
+ *   on SIMD kernels, with map chains fused into one pass
  * - Function calls
  * - Return statements (kembalikan/return)
- * - File I/O (baca_file/tulis_file)
+ * - File I/O (baca_file/tulis_file), batch reads on io_uring (baca_banyak)
  * - String concatenation with runtime helper
+ * - Allocation-free byte scanning (kode_at/is_digit_kode/is_letter_kode)
+ * - Large sources lexed in parallel, split at line boundaries
  * 
  * Author: Ridwan Gatro
  * License: MIT
  * 
- * Compile: g++ -std=c++17 -O2 -o wearc wear_bootstrap.cpp
+ * Compile: g++ -std=c++17 -O2 -pthread -o wearc wear_bootstrap.cpp
  * Usage:   wearc input.wr [-o output.c] [--compile]
  */
 
 #include <iostream>
 #include <fstream>
+#include <algorithm>
+#include <array>
+#include <bitset>
 #include <sstream>
 #include <string>
 #include <vector>
 #include <unordered_map>
 #include <unordered_set>
+#include <map>
+#include <memory>
+#include <set>
 #include <cctype>
+#include <climits>
+#include <cstdint>
 #include <cstdlib>
+#include <filesystem>
+#include <atomic>
+#include <thread>
 
 // ============================================================
 // WeaR Runtime Library (injected into generated C code)
@@ -45,6 +80,16 @@ const char* WEAR_RUNTIME = R"(
 #include <stdlib.h>
 #include <string.h>
 
+/* Cache-line aligned blocks (MinGW has no aligned_alloc) */
+#ifdef _WIN32
+#include <malloc.h>
+#define __wear_aligned_alloc(align, size) _aligned_malloc((size), (align))
+#define __wear_aligned_free _aligned_free
+#else
+#define __wear_aligned_alloc aligned_alloc
+#define __wear_aligned_free free
+#endif
+
 /* String concatenation helper */
 char* __wear_concat(const char* a, const char* b) {
     size_t len_a = strlen(a);
@@ -86,6 +131,55 @@ char* __wear_concat_int_str(int n, const char* s) {
     return result;
 }
 
+/* Growable string buffer. A loop that only grows a string with
+ * 's = s + x' appends here and materializes the string once after the
+ * loop, instead of copying the whole string every iteration. */
+typedef struct {
+    char* data;
+    int len;
+    int cap;
+} __wear_builder;
+
+void __wear_builder_init(__wear_builder* b, const char* s) {
+    b->len = (int)strlen(s);
+    b->cap = b->len < 32 ? 64 : b->len * 2;
+    b->data = (char*)malloc(b->cap);
+    if (b->data == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(1);
+    }
+    memcpy(b->data, s, b->len + 1);
+}
+
+void __wear_builder_append_bytes(__wear_builder* b, const char* s, int n) {
+    if (b->len + n + 1 > b->cap) {
+        while (b->len + n + 1 > b->cap) b->cap *= 2;
+        b->data = (char*)realloc(b->data, b->cap);
+        if (b->data == NULL) {
+            fprintf(stderr, "Error: Memory allocation failed\n");
+            exit(1);
+        }
+    }
+    memcpy(b->data + b->len, s, n);
+    b->len += n;
+    b->data[b->len] = '\0';
+}
+
+void __wear_builder_append(__wear_builder* b, const char* s) {
+    __wear_builder_append_bytes(b, s, (int)strlen(s));
+}
+
+void __wear_builder_append_int(__wear_builder* b, int value) {
+    char digits[16];
+    sprintf(digits, "%d", value);
+    __wear_builder_append(b, digits);
+}
+
+/* The finished string (the builder must not be used afterwards) */
+char* __wear_builder_finish(__wear_builder* b) {
+    return b->data;
+}
+
 /* Read file contents */
 char* __wear_read_file(const char* filename) {
     FILE* file = fopen(filename, "rb");
@@ -124,13 +218,27 @@ void __wear_write_file(const char* filename, const char* content) {
     fclose(file);
 }
 
+/* Where cetak writes when not NULL: inside a paralel loop each thread
+ * collects its lines here and writes them out a chunk at a time */
+static __thread __wear_builder* __wear_out = NULL;
+
 /* Print string */
 void __wear_print_str(const char* s) {
+    if (__wear_out != NULL) {
+        __wear_builder_append(__wear_out, s);
+        __wear_builder_append_bytes(__wear_out, "\n", 1);
+        return;
+    }
     printf("%s\n", s);
 }
 
 /* Print integer */
 void __wear_print_int(int n) {
+    if (__wear_out != NULL) {
+        __wear_builder_append_int(__wear_out, n);
+        __wear_builder_append_bytes(__wear_out, "\n", 1);
+        return;
+    }
     printf("%d\n", n);
 }
 
@@ -144,6 +252,20 @@ int __wear_strlen(const char* s) {
     return (int)strlen(s);
 }
 
+/* Length of the most recently indexed string (per thread).
+ * WeaR strings are immutable, so scanners that index the same source
+ * over and over only pay for strlen once instead of once per character. */
+static __thread const char* __wear_len_cache_str = NULL;
+static __thread int __wear_len_cache_len = 0;
+
+int __wear_cached_len(const char* s) {
+    if (s != __wear_len_cache_str) {
+        __wear_len_cache_str = s;
+        __wear_len_cache_len = (int)strlen(s);
+    }
+    return __wear_len_cache_len;
+}
+
 /* Character at index (returns 1-char string) */
 char* __wear_char_at(const char* s, int index) {
     char* result = (char*)malloc(2);
@@ -151,7 +273,7 @@ char* __wear_char_at(const char* s, int index) {
         fprintf(stderr, "Error: Memory allocation failed\n");
         exit(1);
     }
-    if (index >= 0 && index < (int)strlen(s)) {
+    if (index >= 0 && index < __wear_cached_len(s)) {
         result[0] = s[index];
         result[1] = '\0';
     } else {
@@ -160,6 +282,32 @@ char* __wear_char_at(const char* s, int index) {
     return result;
 }
 
+/* Byte at index as an int (0 when out of range), no allocation */
+int __wear_kode_at(const char* s, int index) {
+    if (index < 0 || index >= __wear_cached_len(s)) return 0;
+    return (unsigned char)s[index];
+}
+
+/* Character class lookup table: bit 1 = digit, bit 2 = letter (A-Z, a-z, _) */
+#define __WEAR_CLASS_DIGIT  1
+#define __WEAR_CLASS_LETTER 2
+static const unsigned char __wear_char_class[256] = {
+    ['0' ... '9'] = __WEAR_CLASS_DIGIT,
+    ['A' ... 'Z'] = __WEAR_CLASS_LETTER,
+    ['a' ... 'z'] = __WEAR_CLASS_LETTER,
+    ['_'] = __WEAR_CLASS_LETTER
+};
+
+/* Check if byte code is a digit (returns 1 if digit, 0 otherwise) */
+int __wear_is_digit_kode(int code) {
+    return (__wear_char_class[code & 0xFF] & __WEAR_CLASS_DIGIT) ? 1 : 0;
+}
+
+/* Check if byte code is a letter or underscore (returns 1 if letter, 0 otherwise) */
+int __wear_is_letter_kode(int code) {
+    return (__wear_char_class[code & 0xFF] & __WEAR_CLASS_LETTER) ? 1 : 0;
+}
+
 /* Check if character is a quote (returns 1 if quote, 0 otherwise) */
 int __wear_is_quote(const char* s) {
     if (s == NULL || s[0] == '\0') return 0;
@@ -188,855 +336,7603 @@ int __wear_is_newline(const char* s) {
     return (s[0] == '\n' || s[0] == '\r') ? 1 : 0;
 }
 
-/* ============================================================ */
+/* Scanning loop primitives. Both return the first index in [start, limit)
+ * where a character-by-character scan stops, or limit when it does not.
+ * Outside the string char_at gives "", so 'empty_continues' (entry 0 of
+ * a class table) decides whether the scan runs on to limit there. */
 
-)";
+/* Advance while table[byte] is set */
+int __wear_span_class(const char* s, int start, int limit, const unsigned char* table) {
+    int len = __wear_cached_len(s);
+    int i = start;
+    for (; i < limit && i < 0; i++) {
+        if (!table[0]) return i;
+    }
+    int end = limit < len ? limit : len;
+    const unsigned char* p = (const unsigned char*)s;
+    while (i + 4 <= end && table[p[i]] && table[p[i + 1]] && table[p[i + 2]] && table[p[i + 3]]) i += 4;
+    while (i < end && table[p[i]]) i++;
+    if (i < end) return i;
+    return (i < limit && table[0]) ? limit : i;
+}
 
-// ============================================================
-// Token Types
-// ============================================================
+/* Advance until the given byte (memchr) */
+int __wear_find_byte(const char* s, int start, int limit, int byte, int empty_continues) {
+    int len = __wear_cached_len(s);
+    int i = start;
+    for (; i < limit && i < 0; i++) {
+        if (!empty_continues) return i;
+    }
+    int end = limit < len ? limit : len;
+    if (i < end) {
+        const char* hit = (const char*)memchr(s + i, byte, end - i);
+        if (hit != NULL) return (int)(hit - s);
+        i = end;
+    }
+    return (i < limit && empty_continues) ? limit : i;
+}
 
-enum class TokenType {
-    // Keywords
-    VAR,
-    CETAK,      // print
-    SELAMA,     // while
-    JIKA,       // if
-    LAINNYA,    // else
-    FUNGSI,     // function
-    KEMBALIKAN, // return
-    BACA_FILE,  // read_file
-    TULIS_FILE, // write_file
-    SAMA,       // string equality
-    PANJANG,    // string length
-    CHAR_AT,    // character at index
-    IS_QUOTE,   // check if character is quote
-    QUOTE_CHAR, // get quote character
-    IS_NEWLINE, // check if character is newline
-    NEWLINE_CHAR, // get newline character
-    
-    // Literals
-    INTEGER,
-    STRING,
-    IDENTIFIER,
-    
-    // Operators
-    PLUS,
-    MINUS,
-    STAR,
-    SLASH,
-    EQUAL,
-    LESS,
-    GREATER,
-    LESS_EQUAL,
-    GREATER_EQUAL,
-    EQUAL_EQUAL,
-    NOT_EQUAL,
-    
-    // Delimiters
-    LPAREN,
-    RPAREN,
-    LBRACE,
-    RBRACE,
-    LBRACKET,
-    RBRACKET,
-    SEMICOLON,
-    COMMA,
-    NEWLINE,    // Line terminator
-    
-    // Special
-    END_OF_FILE,
-    UNKNOWN
-};
+/* a + the characters of s in [start, end) (clamped to the string) */
+char* __wear_concat_range(const char* a, const char* s, int start, int end) {
+    int len = __wear_cached_len(s);
+    if (start < 0) start = 0;
+    if (end > len) end = len;
+    int n = end > start ? end - start : 0;
+    int a_len = (int)strlen(a);
+    char* result = (char*)malloc(a_len + n + 1);
+    if (result == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(1);
+    }
+    memcpy(result, a, a_len);
+    memcpy(result + a_len, s + start, n);
+    result[a_len + n] = '\0';
+    return result;
+}
 
-// ============================================================
-// Token Structure
-// ============================================================
+void __wear_builder_append_range(__wear_builder* b, const char* s, int start, int end) {
+    int len = __wear_cached_len(s);
+    if (start < 0) start = 0;
+    if (end > len) end = len;
+    if (end > start) __wear_builder_append_bytes(b, s + start, end - start);
+}
 
-struct Token {
-    TokenType type;
-    std::string value;
-    int line;
-    int column;
-    
-    Token(TokenType t, const std::string& v, int l, int c)
-        : type(t), value(v), line(l), column(c) {}
-};
+/* String view: a slice of a parent string, shared instead of copied.
+ * 'owner' is the string it was cut from. Views only become
+ * NUL-terminated strings where a C string is required. */
+typedef struct {
+    const char* ptr;
+    int len;
+    const char* owner;
+} __wear_view;
 
-// ============================================================
-// Lexer
-// ============================================================
+__wear_view __wear_view_of(const char* s) {
+    __wear_view v;
+    v.ptr = s;
+    v.len = __wear_cached_len(s);
+    v.owner = s;
+    return v;
+}
 
-class Lexer {
-private:
-    std::string source;
-    size_t pos = 0;
-    int line = 1;
-    int column = 1;
-    
-    std::unordered_map<std::string, TokenType> keywords;
-    
-    char current() const {
-        return pos < source.length() ? source[pos] : '\0';
+/* potong(s, start, len), clamped to the string like char_at */
+__wear_view __wear_view_slice(__wear_view v, int start, int len) {
+    if (start < 0) start = 0;
+    if (start > v.len) start = v.len;
+    if (len < 0) len = 0;
+    if (len > v.len - start) len = v.len - start;
+    v.ptr += start;
+    v.len = len;
+    return v;
+}
+
+/* Copy of the view as a NUL-terminated string */
+char* __wear_view_str(__wear_view v) {
+    char* result = (char*)malloc(v.len + 1);
+    if (result == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(1);
     }
-    
-    char peek(int offset = 1) const {
-        size_t idx = pos + offset;
-        return idx < source.length() ? source[idx] : '\0';
+    memcpy(result, v.ptr, v.len);
+    result[v.len] = '\0';
+    return result;
+}
+
+int __wear_view_eq(__wear_view a, __wear_view b) {
+    return a.len == b.len && memcmp(a.ptr, b.ptr, a.len) == 0 ? 1 : 0;
+}
+
+char* __wear_view_char_at(__wear_view v, int index) {
+    return __wear_view_str(__wear_view_slice(v, index, index >= 0 ? 1 : 0));
+}
+
+int __wear_view_kode_at(__wear_view v, int index) {
+    if (index < 0 || index >= v.len) return 0;
+    return (unsigned char)v.ptr[index];
+}
+
+/* String + view concatenation */
+char* __wear_concat_view(const char* a, __wear_view v) {
+    int a_len = (int)strlen(a);
+    char* result = (char*)malloc(a_len + v.len + 1);
+    if (result == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(1);
     }
-    
-    void advance() {
-        if (current() == '\n') {
-            line++;
-            column = 1;
-        } else {
-            column++;
-        }
-        pos++;
+    memcpy(result, a, a_len);
+    memcpy(result + a_len, v.ptr, v.len);
+    result[a_len + v.len] = '\0';
+    return result;
+}
+
+void __wear_builder_append_view(__wear_builder* b, __wear_view v) {
+    __wear_builder_append_bytes(b, v.ptr, v.len);
+}
+
+void __wear_print_view(__wear_view v) {
+    if (__wear_out != NULL) {
+        __wear_builder_append_bytes(__wear_out, v.ptr, v.len);
+        __wear_builder_append_bytes(__wear_out, "\n", 1);
+        return;
     }
-    
-    void skipWhitespace() {
-        // Skip spaces and tabs, but NOT newlines (they're significant)
-        while (current() == ' ' || current() == '\t' || current() == '\r') {
-            advance();
-        }
+    fwrite(v.ptr, 1, v.len, stdout);
+    putchar('\n');
+}
+
+/* Fixed-length array of ints, strings or views */
+typedef struct {
+    int length;
+    int elem_size;
+    char* data;
+} __wear_array;
+
+/* Zero-filled array (ints are 0, strings NULL, views empty) */
+__wear_array* __wear_array_new(int length, int elem_size) {
+    __wear_array* a = (__wear_array*)malloc(sizeof(__wear_array));
+    char* data = (char*)calloc(length > 0 ? length : 1, elem_size);
+    if (a == NULL || data == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(1);
     }
-    
-    void skipLineComment() {
-        while (current() != '\n' && current() != '\0') {
-            advance();
-        }
+    a->length = length;
+    a->elem_size = elem_size;
+    a->data = data;
+    return a;
+}
+
+/* Array literal: copies 'length' elements from 'items' */
+__wear_array* __wear_array_from(int length, int elem_size, const void* items) {
+    __wear_array* a = __wear_array_new(length, elem_size);
+    memcpy(a->data, items, (size_t)length * elem_size);
+    return a;
+}
+
+/* Address of element 'index'; indexing outside the array is fatal */
+void* __wear_array_at(__wear_array* a, int index) {
+    if (index < 0 || index >= a->length) {
+        fprintf(stderr, "Error: Array index %d out of range (length %d)\n", index, a->length);
+        exit(1);
     }
-    
-    Token scanString() {
-        int startLine = line;
-        int startCol = column;
-        advance(); // skip opening quote
-        
-        std::string value;
-        while (current() != '"' && current() != '\0') {
-            if (current() == '\\' && peek() == '"') {
-                advance();
-                value += '"';
-            } else if (current() == '\\' && peek() == 'n') {
-                advance();
-                advance();
-                value += "\\n";
-            } else {
-                value += current();
-                advance();
-            }
-        }
-        
-        if (current() == '"') {
-            advance(); // skip closing quote
-        }
-        
-        return Token(TokenType::STRING, value, startLine, startCol);
+    return a->data + (size_t)index * a->elem_size;
+}
+
+/* "[1, 2, 3]" for printing and concatenation (kind: 0 int, 1 string, 2 view) */
+char* __wear_array_str(__wear_array* a, int kind) {
+    __wear_builder b;
+    __wear_builder_init(&b, "[");
+    for (int i = 0; i < a->length; i++) {
+        if (i > 0) __wear_builder_append(&b, ", ");
+        void* item = a->data + (size_t)i * a->elem_size;
+        if (kind == 0) __wear_builder_append_int(&b, *(int*)item);
+        else if (kind == 1) __wear_builder_append(&b, *(char**)item != NULL ? *(char**)item : "");
+        else __wear_builder_append_view(&b, *(__wear_view*)item);
     }
-    
-    Token scanNumber() {
-        int startLine = line;
-        int startCol = column;
-        std::string value;
-        
-        while (std::isdigit(current())) {
-            value += current();
-            advance();
-        }
-        
-        return Token(TokenType::INTEGER, value, startLine, startCol);
+    __wear_builder_append(&b, "]");
+    return __wear_builder_finish(&b);
+}
+
+/* Index of the first 'needle' in v at or after 'from', or -1 */
+int __wear_view_find(__wear_view v, int from, __wear_view needle) {
+    if (needle.len == 0) return from <= v.len ? from : -1;
+    const char* end = v.ptr + v.len;
+    const char* p = v.ptr + from;
+    while (end - p >= needle.len) {
+        p = (const char*)memchr(p, needle.ptr[0], (end - p) - needle.len + 1);
+        if (p == NULL) return -1;
+        if (memcmp(p, needle.ptr, needle.len) == 0) return (int)(p - v.ptr);
+        p++;
     }
-    
-    Token scanIdentifier() {
-        int startLine = line;
-        int startCol = column;
-        std::string value;
-        
-        while (std::isalnum(current()) || current() == '_') {
-            value += current();
-            advance();
-        }
-        
-        auto it = keywords.find(value);
-        if (it != keywords.end()) {
-            return Token(it->second, value, startLine, startCol);
+    return -1;
+}
+
+/* Matcher for cocok(s, /pattern/). The compiler turns each pattern into
+ * a minimal DFA; 'classes' maps every byte to a column of 'next'. */
+typedef struct {
+    const unsigned char* classes;
+    const unsigned short* next;     /* [state * columns + column] */
+    const unsigned char* accept;
+    int columns;
+    int start;
+    int dead;                       /* State that can never accept, or -1 */
+    int stop_early;                 /* No '$': the first accepting state decides */
+} __wear_dfa;
+
+int __wear_dfa_match(__wear_view v, const __wear_dfa* d) {
+    const unsigned char* p = (const unsigned char*)v.ptr;
+    int state = d->start;
+    for (int i = 0; i < v.len; i++) {
+        if (d->stop_early && d->accept[state]) return 1;
+        state = d->next[state * d->columns + d->classes[p[i]]];
+        if (state == d->dead) return 0;
+    }
+    return d->accept[state];
+}
+
+/* pisah(s, delim): the fields of s between delimiters, as views into s.
+ * Adjacent delimiters give empty fields; an empty delimiter gives s. */
+__wear_array* __wear_pisah(__wear_view s, __wear_view delim) {
+    int count = 1;
+    if (delim.len > 0) {
+        for (int at = __wear_view_find(s, 0, delim); at >= 0; at = __wear_view_find(s, at + delim.len, delim)) {
+            count++;
         }
-        
-        return Token(TokenType::IDENTIFIER, value, startLine, startCol);
     }
+    __wear_array* fields = __wear_array_new(count, sizeof(__wear_view));
+    __wear_view* out = (__wear_view*)fields->data;
+    int start = 0;
+    for (int i = 0; i < count - 1; i++) {
+        int at = __wear_view_find(s, start, delim);
+        out[i] = __wear_view_slice(s, start, at - start);
+        start = at + delim.len;
+    }
+    out[count - 1] = __wear_view_slice(s, start, s.len - start);
+    return fields;
+}
 
-public:
-    explicit Lexer(const std::string& src) : source(src) {
-        // Indonesian keywords
-        keywords["var"] = TokenType::VAR;
+/* ============================================================ */
+
+)";
+
+// Memoization cache for @ingat functions (only emitted when used)
+const char* WEAR_MEMO_RUNTIME = R"(
+/* ============================================================
+ * Memoization (@ingat)
+ * Open-addressing table per function. Keys are the serialized
+ * arguments: ints by value, strings by content (FNV-1a hashed).
+ * A spin lock per table lets paralel loops call @ingat functions; it is
+ * held for the lookup and the store, never while the body runs.
+ * ============================================================ */
+
+typedef struct {
+    char* key;              /* Serialized arguments (NULL = empty slot) */
+    int key_len;
+    unsigned int hash;
+    int int_value;
+    char* str_value;
+} __wear_memo_slot;
+
+typedef struct __wear_memo {
+    const char* name;
+    int limit;              /* Entries before the table is flushed (0 = unbounded) */
+    __wear_memo_slot* slots;
+    int capacity;           /* Power of two */
+    int count;
+    long long hits;
+    long long misses;
+    long long evictions;
+    struct __wear_memo* next;   /* Tables seen so far, for the stats report */
+    int lock;
+} __wear_memo;
+
+typedef struct {
+    char small[64];
+    char* data;
+    int len;
+    int cap;
+} __wear_memo_key;
+
+static __wear_memo* __wear_memo_tables = NULL;
+
+static void __wear_memo_lock(__wear_memo* m) {
+    while (__atomic_exchange_n(&m->lock, 1, __ATOMIC_ACQUIRE)) {
+        while (__atomic_load_n(&m->lock, __ATOMIC_RELAXED)) {
+        }
+    }
+}
+
+static void __wear_memo_unlock(__wear_memo* m) {
+    __atomic_store_n(&m->lock, 0, __ATOMIC_RELEASE);
+}
+
+static void __wear_memo_key_init(__wear_memo_key* k) {
+    k->data = k->small;
+    k->len = 0;
+    k->cap = (int)sizeof(k->small);
+}
+
+static void __wear_memo_key_put(__wear_memo_key* k, const void* bytes, int n) {
+    if (k->len + n > k->cap) {
+        int cap = k->cap * 2;
+        while (cap < k->len + n) cap *= 2;
+        char* data = (char*)malloc(cap);
+        memcpy(data, k->data, k->len);
+        if (k->data != k->small) free(k->data);
+        k->data = data;
+        k->cap = cap;
+    }
+    memcpy(k->data + k->len, bytes, n);
+    k->len += n;
+}
+
+__attribute__((unused))
+static void __wear_memo_key_int(__wear_memo_key* k, int v) {
+    __wear_memo_key_put(k, &v, (int)sizeof(v));
+}
+
+/* Length first, so ("ab", "c") and ("a", "bc") differ */
+__attribute__((unused))
+static void __wear_memo_key_str(__wear_memo_key* k, const char* s) {
+    int n = (int)strlen(s);
+    __wear_memo_key_put(k, &n, (int)sizeof(n));
+    __wear_memo_key_put(k, s, n);
+}
+
+/* A view is keyed by its bytes, like the string it stands for */
+__attribute__((unused))
+static void __wear_memo_key_view(__wear_memo_key* k, __wear_view v) {
+    __wear_memo_key_put(k, &v.len, (int)sizeof(v.len));
+    __wear_memo_key_put(k, v.ptr, v.len);
+}
+
+static void __wear_memo_key_free(__wear_memo_key* k) {
+    if (k->data != k->small) free(k->data);
+}
+
+static unsigned int __wear_memo_hash(const __wear_memo_key* k) {
+    unsigned int h = 2166136261u;
+    for (int i = 0; i < k->len; i++) {
+        h = (h ^ (unsigned char)k->data[i]) * 16777619u;
+    }
+    return h;
+}
+
+/* Slot holding the key, or the empty slot where it would go */
+static __wear_memo_slot* __wear_memo_probe(__wear_memo* m, const __wear_memo_key* k, unsigned int hash) {
+    unsigned int mask = (unsigned int)m->capacity - 1;
+    for (unsigned int i = hash & mask;; i = (i + 1) & mask) {
+        __wear_memo_slot* slot = &m->slots[i];
+        if (slot->key == NULL) return slot;
+        if (slot->hash == hash && slot->key_len == k->len && memcmp(slot->key, k->data, k->len) == 0) {
+            return slot;
+        }
+    }
+}
+
+/* Cached result for the key, or NULL */
+static __wear_memo_slot* __wear_memo_find(__wear_memo* m, const __wear_memo_key* k) {
+    if (m->slots != NULL) {
+        __wear_memo_slot* slot = __wear_memo_probe(m, k, __wear_memo_hash(k));
+        if (slot->key != NULL) {
+            m->hits++;
+            return slot;
+        }
+    }
+    m->misses++;
+    return NULL;
+}
+
+static void __wear_memo_flush(__wear_memo* m) {
+    for (int i = 0; i < m->capacity; i++) {
+        free(m->slots[i].key);
+        m->slots[i].key = NULL;
+    }
+    m->evictions += m->count;
+    m->count = 0;
+}
+
+static void __wear_memo_grow(__wear_memo* m) {
+    __wear_memo_slot* old = m->slots;
+    int old_capacity = m->capacity;
+    m->capacity = old_capacity == 0 ? 64 : old_capacity * 2;
+    m->slots = (__wear_memo_slot*)calloc(m->capacity, sizeof(__wear_memo_slot));
+    if (m->slots == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(1);
+    }
+    if (old == NULL) {
+        m->next = __atomic_load_n(&__wear_memo_tables, __ATOMIC_RELAXED);
+        while (!__atomic_compare_exchange_n(&__wear_memo_tables, &m->next, m, 0,
+                                            __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+        }
+    }
+    for (int i = 0; i < old_capacity; i++) {
+        if (old[i].key == NULL) continue;
+        __wear_memo_key k;
+        k.data = old[i].key;
+        k.len = old[i].key_len;
+        *__wear_memo_probe(m, &k, old[i].hash) = old[i];
+    }
+    free(old);
+}
+
+/* Insert a result; a bounded table is flushed when it is full */
+static __wear_memo_slot* __wear_memo_insert(__wear_memo* m, const __wear_memo_key* k) {
+    if (m->limit > 0 && m->count >= m->limit) __wear_memo_flush(m);
+    if ((m->count + 1) * 2 > m->capacity) __wear_memo_grow(m);
+    unsigned int hash = __wear_memo_hash(k);
+    __wear_memo_slot* slot = __wear_memo_probe(m, k, hash);
+    if (slot->key == NULL) {
+        slot->key = (char*)malloc(k->len > 0 ? k->len : 1);
+        memcpy(slot->key, k->data, k->len);
+        slot->key_len = k->len;
+        slot->hash = hash;
+        m->count++;
+    }
+    return slot;
+}
+
+/* Copy out a cached result; 1 on a hit */
+__attribute__((unused))
+static int __wear_memo_find_int(__wear_memo* m, const __wear_memo_key* k, int* v) {
+    __wear_memo_lock(m);
+    __wear_memo_slot* slot = __wear_memo_find(m, k);
+    if (slot != NULL) *v = slot->int_value;
+    __wear_memo_unlock(m);
+    return slot != NULL;
+}
+
+__attribute__((unused))
+static int __wear_memo_find_str(__wear_memo* m, const __wear_memo_key* k, char** v) {
+    __wear_memo_lock(m);
+    __wear_memo_slot* slot = __wear_memo_find(m, k);
+    if (slot != NULL) *v = slot->str_value;
+    __wear_memo_unlock(m);
+    return slot != NULL;
+}
+
+__attribute__((unused))
+static void __wear_memo_store_int(__wear_memo* m, const __wear_memo_key* k, int v) {
+    __wear_memo_lock(m);
+    __wear_memo_insert(m, k)->int_value = v;
+    __wear_memo_unlock(m);
+}
+
+__attribute__((unused))
+static void __wear_memo_store_str(__wear_memo* m, const __wear_memo_key* k, char* v) {
+    __wear_memo_lock(m);
+    __wear_memo_insert(m, k)->str_value = v;
+    __wear_memo_unlock(m);
+}
+
+/* Hit rates per table (--memo-stats) */
+void __wear_memo_report(void) {
+    for (__wear_memo* m = __wear_memo_tables; m != NULL; m = m->next) {
+        long long calls = m->hits + m->misses;
+        fprintf(stderr, "[ingat] %s: %lld calls, %lld hits (%.1f%%), %d cached, %lld evicted\n",
+                m->name, calls, m->hits, calls > 0 ? 100.0 * m->hits / calls : 0.0,
+                m->count, m->evictions);
+    }
+}
+
+/* ============================================================ */
+
+)";
+
+// Thread pool shared by the parallel builtins (only emitted when used)
+const char* WEAR_POOL_RUNTIME = R"(
+/* ============================================================
+ * Thread pool
+ * A fixed set of workers (one per CPU, or WEAR_THREADS) started on
+ * first use. __wear_pool_run calls fn(ctx, i) for every i in
+ * [0, tasks) on the workers and the calling thread, and returns when
+ * all calls have finished. Calls made from inside a task run inline.
+ * ============================================================ */
+
+#include <pthread.h>
+#include <unistd.h>
+
+typedef struct {
+    void (*fn)(void* ctx, int task);
+    void* ctx;
+    int tasks;
+    int next;           /* Next task to hand out */
+    int workers;        /* Workers still inside this batch */
+} __wear_batch;
+
+static pthread_mutex_t __wear_pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t __wear_pool_wake = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t __wear_pool_idle = PTHREAD_COND_INITIALIZER;
+static __wear_batch* __wear_pool_batch = NULL;
+static unsigned int __wear_pool_generation = 0;
+static int __wear_pool_size = 0;            /* Threads including the caller */
+static __thread int __wear_pool_inside = 0;
+static __thread int __wear_pool_id = 0;    /* 0 for the caller, 1.. for workers */
+
+int __wear_pool_threads(void) {
+    if (__wear_pool_size == 0) {
+        const char* env = getenv("WEAR_THREADS");
+#ifdef _WIN32
+        long n = env != NULL ? atol(env) : pthread_num_processors_np();
+#else
+        long n = env != NULL ? atol(env) : sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+        __wear_pool_size = n < 1 ? 1 : n > 256 ? 256 : (int)n;
+    }
+    return __wear_pool_size;
+}
+
+static void __wear_pool_work(__wear_batch* b) {
+    for (;;) {
+        int task = __atomic_fetch_add(&b->next, 1, __ATOMIC_RELAXED);
+        if (task >= b->tasks) return;
+        b->fn(b->ctx, task);
+    }
+}
+
+static void* __wear_pool_worker(void* arg) {
+    unsigned int seen = 0;
+    __wear_pool_id = (int)(long)arg;
+    __wear_pool_inside = 1;
+    pthread_mutex_lock(&__wear_pool_lock);
+    for (;;) {
+        while (__wear_pool_generation == seen || __wear_pool_batch == NULL) {
+            if (__wear_pool_batch == NULL) seen = __wear_pool_generation;
+            pthread_cond_wait(&__wear_pool_wake, &__wear_pool_lock);
+        }
+        seen = __wear_pool_generation;
+        __wear_batch* b = __wear_pool_batch;
+        b->workers++;
+        pthread_mutex_unlock(&__wear_pool_lock);
+        __wear_pool_work(b);
+        pthread_mutex_lock(&__wear_pool_lock);
+        if (--b->workers == 0) pthread_cond_broadcast(&__wear_pool_idle);
+    }
+    return NULL;
+}
+
+static void __wear_pool_start(void) {
+    static int started = 0;
+    if (started) return;
+    started = 1;
+    for (int i = 1; i < __wear_pool_threads(); i++) {
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, __wear_pool_worker, (void*)(long)i) != 0) break;
+        pthread_detach(thread);
+    }
+}
+
+void __wear_pool_run(int tasks, void (*fn)(void* ctx, int task), void* ctx) {
+    if (tasks <= 0) return;
+    if (tasks == 1 || __wear_pool_inside || __wear_pool_threads() == 1) {
+        for (int i = 0; i < tasks; i++) fn(ctx, i);
+        return;
+    }
+    __wear_pool_start();
+    
+    __wear_batch b = {fn, ctx, tasks, 0, 0};
+    pthread_mutex_lock(&__wear_pool_lock);
+    __wear_pool_batch = &b;
+    __wear_pool_generation++;
+    pthread_cond_broadcast(&__wear_pool_wake);
+    pthread_mutex_unlock(&__wear_pool_lock);
+    
+    __wear_pool_inside = 1;
+    __wear_pool_work(&b);
+    __wear_pool_inside = 0;
+    
+    /* Every task is handed out; wait for the workers still running one */
+    pthread_mutex_lock(&__wear_pool_lock);
+    __wear_pool_batch = NULL;
+    while (b.workers > 0) pthread_cond_wait(&__wear_pool_idle, &__wear_pool_lock);
+    pthread_mutex_unlock(&__wear_pool_lock);
+}
+
+)";
+
+// urutkan (only emitted when used; needs WEAR_POOL_RUNTIME)
+const char* WEAR_SORT_RUNTIME = R"(
+/* ============================================================
+ * Sorting (urutkan)
+ * Ints use LSD radix sort. Strings and views are sorted as records
+ * caching their first 8 bytes as a big-endian key (introsort), so most
+ * comparisons never touch the string. Large arrays are cut into one
+ * run per thread; runs are sorted on the pool and merged pairwise,
+ * each round's merges running in parallel.
+ * ============================================================ */
+
+#define __WEAR_SORT_PARALLEL 65536   /* Smallest array sorted on the pool */
+
+typedef struct {
+    unsigned long long prefix;
+    __wear_view v;
+} __wear_sort_rec;
+
+/* ---- ints ---- */
+
+static void __wear_radix_sort(char* data, int n, char* scratch) {
+    if (n < 2) return;
+    unsigned int* a = (unsigned int*)data;
+    unsigned int* b = (unsigned int*)scratch;
+    for (int i = 0; i < n; i++) a[i] ^= 0x80000000u;   /* Signed order */
+    for (int shift = 0; shift < 32; shift += 8) {
+        int count[257] = {0};
+        for (int i = 0; i < n; i++) count[((a[i] >> shift) & 0xFF) + 1]++;
+        if (count[((a[0] >> shift) & 0xFF) + 1] == n) continue;   /* One bucket: nothing moves */
+        for (int k = 0; k < 256; k++) count[k + 1] += count[k];
+        for (int i = 0; i < n; i++) b[count[(a[i] >> shift) & 0xFF]++] = a[i];
+        unsigned int* t = a;
+        a = b;
+        b = t;
+    }
+    if ((char*)a != data) memcpy(data, a, (size_t)n * sizeof(int));
+    for (int i = 0; i < n; i++) ((unsigned int*)data)[i] ^= 0x80000000u;
+}
+
+static void __wear_merge_int(const char* x, int nx, const char* y, int ny, char* out) {
+    const int* a = (const int*)x;
+    const int* b = (const int*)y;
+    int* o = (int*)out;
+    int i = 0, j = 0;
+    while (i < nx && j < ny) *o++ = b[j] < a[i] ? b[j++] : a[i++];
+    while (i < nx) *o++ = a[i++];
+    while (j < ny) *o++ = b[j++];
+}
+
+/* ---- strings and views ---- */
+
+static int __wear_rec_less(const __wear_sort_rec* a, const __wear_sort_rec* b) {
+    if (a->prefix != b->prefix) return a->prefix < b->prefix;
+    /* Equal keys and a string within 8 bytes: both end there */
+    if (a->v.len <= 8 || b->v.len <= 8) return a->v.len < b->v.len;
+    int n = a->v.len < b->v.len ? a->v.len : b->v.len;
+    int c = memcmp(a->v.ptr + 8, b->v.ptr + 8, n - 8);
+    return c != 0 ? c < 0 : a->v.len < b->v.len;
+}
+
+static void __wear_rec_swap(__wear_sort_rec* a, __wear_sort_rec* b) {
+    __wear_sort_rec t = *a;
+    *a = *b;
+    *b = t;
+}
+
+static void __wear_rec_sift(__wear_sort_rec* r, int root, int n) {
+    for (;;) {
+        int child = 2 * root + 1;
+        if (child >= n) return;
+        if (child + 1 < n && __wear_rec_less(&r[child], &r[child + 1])) child++;
+        if (!__wear_rec_less(&r[root], &r[child])) return;
+        __wear_rec_swap(&r[root], &r[child]);
+        root = child;
+    }
+}
+
+static void __wear_introsort(__wear_sort_rec* r, int n, int depth) {
+    while (n > 16) {
+        if (depth-- == 0) {
+            /* Quicksort is going quadratic: heapsort the rest */
+            for (int i = n / 2 - 1; i >= 0; i--) __wear_rec_sift(r, i, n);
+            for (int i = n - 1; i > 0; i--) {
+                __wear_rec_swap(&r[0], &r[i]);
+                __wear_rec_sift(r, 0, i);
+            }
+            return;
+        }
+        int mid = n / 2;
+        if (__wear_rec_less(&r[mid], &r[0])) __wear_rec_swap(&r[mid], &r[0]);
+        if (__wear_rec_less(&r[n - 1], &r[mid])) __wear_rec_swap(&r[n - 1], &r[mid]);
+        if (__wear_rec_less(&r[mid], &r[0])) __wear_rec_swap(&r[mid], &r[0]);
+        __wear_sort_rec pivot = r[mid];
+        int i = 0, j = n - 1;
+        for (;;) {
+            while (__wear_rec_less(&r[i], &pivot)) i++;
+            while (__wear_rec_less(&pivot, &r[j])) j--;
+            if (i >= j) break;
+            __wear_rec_swap(&r[i], &r[j]);
+            i++;
+            j--;
+        }
+        /* Recurse into the smaller side, loop on the larger one */
+        if (j + 1 < n - j - 1) {
+            __wear_introsort(r, j + 1, depth);
+            r += j + 1;
+            n -= j + 1;
+        } else {
+            __wear_introsort(r + j + 1, n - j - 1, depth);
+            n = j + 1;
+        }
+    }
+    for (int i = 1; i < n; i++) {
+        __wear_sort_rec item = r[i];
+        int k = i;
+        while (k > 0 && __wear_rec_less(&item, &r[k - 1])) {
+            r[k] = r[k - 1];
+            k--;
+        }
+        r[k] = item;
+    }
+}
+
+static void __wear_rec_sort(char* data, int n, char* scratch) {
+    int depth = 0;
+    (void)scratch;
+    for (int m = n; m > 1; m >>= 1) depth += 2;
+    __wear_introsort((__wear_sort_rec*)data, n, depth);
+}
+
+static void __wear_merge_rec(const char* x, int nx, const char* y, int ny, char* out) {
+    const __wear_sort_rec* a = (const __wear_sort_rec*)x;
+    const __wear_sort_rec* b = (const __wear_sort_rec*)y;
+    __wear_sort_rec* o = (__wear_sort_rec*)out;
+    int i = 0, j = 0;
+    while (i < nx && j < ny) *o++ = __wear_rec_less(&b[j], &a[i]) ? b[j++] : a[i++];
+    while (i < nx) *o++ = a[i++];
+    while (j < ny) *o++ = b[j++];
+}
+
+/* ---- parallel driver ---- */
+
+typedef struct {
+    char* from;         /* Runs of the current round */
+    char* to;           /* Merged runs of the current round */
+    int n;
+    int size;           /* Bytes per element */
+    int runs;
+    int width;          /* Runs per merged group before this round */
+    void (*sort)(char* data, int n, char* scratch);
+    void (*merge)(const char* x, int nx, const char* y, int ny, char* out);
+} __wear_sort_job;
+
+static int __wear_run_start(const __wear_sort_job* job, int run) {
+    if (run >= job->runs) return job->n;
+    return (int)((long long)job->n * run / job->runs);
+}
+
+static void __wear_sort_run(void* ctx, int run) {
+    __wear_sort_job* job = (__wear_sort_job*)ctx;
+    int start = __wear_run_start(job, run);
+    int end = __wear_run_start(job, run + 1);
+    job->sort(job->from + (size_t)start * job->size, end - start, job->to + (size_t)start * job->size);
+}
+
+static void __wear_merge_pair(void* ctx, int pair) {
+    __wear_sort_job* job = (__wear_sort_job*)ctx;
+    int left = pair * 2 * job->width;
+    int a = __wear_run_start(job, left);
+    int b = __wear_run_start(job, left + job->width);
+    int c = __wear_run_start(job, left + 2 * job->width);
+    job->merge(job->from + (size_t)a * job->size, b - a, job->from + (size_t)b * job->size, c - b,
+               job->to + (size_t)a * job->size);
+}
+
+static void __wear_sort_elements(char* data, int n, int size,
+                                 void (*sort)(char*, int, char*),
+                                 void (*merge)(const char*, int, const char*, int, char*)) {
+    char* scratch = (char*)malloc((size_t)(n > 0 ? n : 1) * size);
+    if (scratch == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(1);
+    }
+    int runs = n >= __WEAR_SORT_PARALLEL ? __wear_pool_threads() : 1;
+    __wear_sort_job job = {data, scratch, n, size, runs, 1, sort, merge};
+    __wear_pool_run(runs, __wear_sort_run, &job);
+    
+    /* Merge rounds alternate between the two buffers */
+    for (job.width = 1; job.width < runs; job.width *= 2) {
+        __wear_pool_run((runs + 2 * job.width - 1) / (2 * job.width), __wear_merge_pair, &job);
+        char* t = job.from;
+        job.from = job.to;
+        job.to = t;
+    }
+    if (job.from != data) memcpy(data, job.from, (size_t)n * size);
+    free(scratch);
+}
+
+/* urutkan(a) sorts a in place and returns it (kind: 0 int, 1 string, 2 view) */
+__wear_array* __wear_urutkan(__wear_array* a, int kind) {
+    int n = a->length;
+    if (n < 2) return a;
+    if (kind == 0) {
+        __wear_sort_elements(a->data, n, sizeof(int), __wear_radix_sort, __wear_merge_int);
+        return a;
+    }
+    
+    __wear_sort_rec* recs = (__wear_sort_rec*)malloc((size_t)n * sizeof(__wear_sort_rec));
+    if (recs == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(1);
+    }
+    for (int i = 0; i < n; i++) {
+        __wear_view v;
+        if (kind == 1) {
+            const char* s = ((char**)a->data)[i];
+            v.ptr = s != NULL ? s : "";
+            v.len = (int)strlen(v.ptr);
+            v.owner = v.ptr;
+        } else {
+            v = ((__wear_view*)a->data)[i];
+        }
+        unsigned long long prefix = 0;
+        for (int k = 0; k < 8; k++) {
+            prefix = (prefix << 8) | (k < v.len ? (unsigned char)v.ptr[k] : 0);
+        }
+        recs[i].prefix = prefix;
+        recs[i].v = v;
+    }
+    __wear_sort_elements((char*)recs, n, sizeof(__wear_sort_rec), __wear_rec_sort, __wear_merge_rec);
+    for (int i = 0; i < n; i++) {
+        if (kind == 1) ((const char**)a->data)[i] = recs[i].v.ptr;
+        else ((__wear_view*)a->data)[i] = recs[i].v;
+    }
+    free(recs);
+    return a;
+}
+
+)";
+
+// paralel loops (only emitted when used; needs WEAR_POOL_RUNTIME)
+const char* WEAR_LOOP_RUNTIME = R"(
+/* ============================================================
+ * paralel loops
+ * The compiler outlines a loop body into body(ctx, start, end), which
+ * runs iterations [start, end). __wear_paralel cuts [from, to) into
+ * chunks for the pool:
+ *   statis (default)  one block per thread, or with a chunk size,
+ *                     chunks dealt to the threads round-robin
+ *   dinamis           chunks (by default 1/8 of a thread's share)
+ *                     handed to whichever thread asks next
+ * cetak in the body goes to a buffer of the running thread, written
+ * out in one piece when the chunk ends.
+ * kurangi(op: x) gives each chunk its own x, starting at the identity
+ * of op; at the end of the chunk it is folded into the slot of the
+ * running thread (a cache line per thread, so no two threads write the
+ * same line), and the slots into x after the loop.
+ * ============================================================ */
+
+#include <limits.h>
+
+typedef struct {
+    void (*body)(void* ctx, int start, int end);
+    void* ctx;
+    long long from;
+    long long count;
+    long long chunk;    /* 0: one block per task */
+    int tasks;
+    int dynamic;
+} __wear_loop;
+
+static __thread __wear_builder __wear_loop_lines;
+
+static void __wear_loop_range(__wear_loop* loop, long long start, long long end) {
+    int own = __wear_out == NULL;   /* Nested loops print into the outer chunk */
+    if (own) {
+        if (__wear_loop_lines.data == NULL) __wear_builder_init(&__wear_loop_lines, "");
+        __wear_out = &__wear_loop_lines;
+    }
+    loop->body(loop->ctx, (int)(loop->from + start), (int)(loop->from + end));
+    if (own) {
+        if (__wear_loop_lines.len > 0) fwrite(__wear_loop_lines.data, 1, __wear_loop_lines.len, stdout);
+        __wear_loop_lines.len = 0;
+        __wear_out = NULL;
+    }
+}
+
+static void __wear_loop_task(void* ctx, int task) {
+    __wear_loop* loop = (__wear_loop*)ctx;
+    if (loop->chunk == 0) {
+        __wear_loop_range(loop, loop->count * task / loop->tasks, loop->count * (task + 1) / loop->tasks);
+        return;
+    }
+    /* Dynamic: task k is chunk k. Static: task t takes chunks t, t + tasks, ... */
+    long long stride = loop->dynamic ? loop->count : loop->chunk * loop->tasks;
+    for (long long start = task * loop->chunk; start < loop->count; start += stride) {
+        long long end = start + loop->chunk;
+        __wear_loop_range(loop, start, end < loop->count ? end : loop->count);
+    }
+}
+
+/* Reduction operators: 0 +, 1 *, 2 min, 3 maks */
+typedef struct {
+    int value;
+    char pad[60];
+} __wear_slot;
+
+static int __wear_reduce_op(int op, int a, int b) {
+    switch (op) {
+        case 0: return a + b;
+        case 1: return a * b;
+        case 2: return b < a ? b : a;
+        default: return b > a ? b : a;
+    }
+}
+
+__wear_slot* __wear_reduce_slots(int identity) {
+    int threads = __wear_pool_threads();
+    __wear_slot* slots = (__wear_slot*)__wear_aligned_alloc(64, sizeof(__wear_slot) * threads);
+    if (slots == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(1);
+    }
+    for (int k = 0; k < threads; k++) slots[k].value = identity;
+    return slots;
+}
+
+void __wear_reduce_into(__wear_slot* slots, int op, int partial) {
+    __wear_slot* slot = &slots[__wear_pool_id];
+    slot->value = __wear_reduce_op(op, slot->value, partial);
+}
+
+int __wear_reduce_finish(__wear_slot* slots, int op, int value) {
+    for (int k = 0; k < __wear_pool_threads(); k++) value = __wear_reduce_op(op, value, slots[k].value);
+    __wear_aligned_free(slots);
+    return value;
+}
+
+void __wear_paralel(int from, int to, int chunk, int dynamic,
+                    void (*body)(void* ctx, int start, int end), void* ctx) {
+    long long count = (long long)to - from;
+    if (count <= 0) return;
+    int threads = __wear_pool_threads();
+    __wear_loop loop = {body, ctx, from, count, chunk > 0 ? chunk : 0, threads, dynamic};
+    if (dynamic) {
+        if (loop.chunk == 0) loop.chunk = count / (8LL * threads);
+        if (loop.chunk == 0) loop.chunk = 1;
+        long long tasks = (count + loop.chunk - 1) / loop.chunk;
+        loop.tasks = tasks < INT_MAX ? (int)tasks : INT_MAX;
+        if (loop.tasks == INT_MAX) loop.chunk = (count + INT_MAX - 1) / INT_MAX;
+    } else if (loop.chunk == 0 && count < threads) {
+        loop.tasks = (int)count;
+    }
+    __wear_pool_run(loop.tasks, __wear_loop_task, &loop);
+}
+
+)";
+
+// jalankan/tunggu (only emitted when used; needs WEAR_POOL_RUNTIME)
+const char* WEAR_TASK_RUNTIME = R"(
+/* ============================================================
+ * Tasks (jalankan / tunggu)
+ * Work-stealing scheduler. Every scheduler thread owns a Chase-Lev
+ * deque: jalankan pushes onto the spawning thread's deque, the owner
+ * pops the newest task and idle threads steal the oldest (in divide
+ * and conquer code, the biggest piece left). tunggu runs other tasks
+ * until the awaited one has finished. Idle threads spin, then yield,
+ * then sleep until a push wakes them.
+ * The first thread to call jalankan joins the scheduler; tasks spawned
+ * on any other thread (e.g. inside a paralel loop) run right away.
+ * A task stays allocated after it finishes: handles are plain values
+ * that can be copied, and every tunggu on one returns the same result.
+ * Tasks that may wait on a channel get a thread of their own instead:
+ * run inside tunggu, they could hold up the task that feeds them.
+ * ============================================================ */
+
+#include <sched.h>
+
+typedef struct __wear_task {
+    void (*run)(struct __wear_task* t);   /* Calls the function, sets the result */
+    int done;
+    union {
+        int i;
+        char* s;
+    } result;
+} __wear_task;
+
+typedef struct {
+    long long size;                 /* Power of two */
+    __wear_task** slots;
+} __wear_ring;
+
+typedef struct {
+    long long top;                  /* Thieves take from here */
+    char pad1[56];
+    long long bottom;               /* The owner pushes and pops here */
+    __wear_ring* ring;
+    char pad2[48];
+} __wear_deque;
+
+#define __WEAR_SPIN_ROUNDS 64       /* Failed searches before yielding */
+#define __WEAR_YIELD_ROUNDS 128     /* ... and before sleeping */
+
+static __wear_deque* __wear_deques = NULL;
+static int __wear_sched_size = 0;
+static int __wear_sched_started = 0;
+static int __wear_sched_sleepers = 0;
+static pthread_mutex_t __wear_sched_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t __wear_sched_wake = PTHREAD_COND_INITIALIZER;
+static __thread int __wear_sched_id = -1;
+static __thread unsigned int __wear_steal_seed = 0;
+
+/* ---- deque ---- */
+
+static __wear_ring* __wear_ring_new(long long size) {
+    __wear_ring* r = (__wear_ring*)malloc(sizeof(__wear_ring));
+    __wear_task** slots = (__wear_task**)calloc((size_t)size, sizeof(__wear_task*));
+    if (r == NULL || slots == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(1);
+    }
+    r->size = size;
+    r->slots = slots;
+    return r;
+}
+
+static __wear_task* __wear_ring_get(__wear_ring* r, long long i) {
+    return __atomic_load_n(&r->slots[i & (r->size - 1)], __ATOMIC_ACQUIRE);
+}
+
+static void __wear_ring_put(__wear_ring* r, long long i, __wear_task* t) {
+    __atomic_store_n(&r->slots[i & (r->size - 1)], t, __ATOMIC_RELEASE);
+}
+
+static void __wear_deque_push(__wear_deque* q, __wear_task* t) {
+    long long b = __atomic_load_n(&q->bottom, __ATOMIC_RELAXED);
+    long long top = __atomic_load_n(&q->top, __ATOMIC_ACQUIRE);
+    __wear_ring* r = __atomic_load_n(&q->ring, __ATOMIC_RELAXED);
+    if (b - top > r->size - 1) {
+        /* Full: move to a ring twice the size. The old ring is never
+         * freed, since a thief may still be reading from it. */
+        __wear_ring* bigger = __wear_ring_new(r->size * 2);
+        for (long long i = top; i < b; i++) __wear_ring_put(bigger, i, __wear_ring_get(r, i));
+        __atomic_store_n(&q->ring, bigger, __ATOMIC_RELEASE);
+        r = bigger;
+    }
+    __wear_ring_put(r, b, t);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    __atomic_store_n(&q->bottom, b + 1, __ATOMIC_RELAXED);
+}
+
+static __wear_task* __wear_deque_pop(__wear_deque* q) {
+    long long b = __atomic_load_n(&q->bottom, __ATOMIC_RELAXED) - 1;
+    __wear_ring* r = __atomic_load_n(&q->ring, __ATOMIC_RELAXED);
+    __atomic_store_n(&q->bottom, b, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    long long top = __atomic_load_n(&q->top, __ATOMIC_RELAXED);
+    if (top > b) {
+        __atomic_store_n(&q->bottom, b + 1, __ATOMIC_RELAXED);
+        return NULL;
+    }
+    __wear_task* t = __wear_ring_get(r, b);
+    if (top == b) {
+        /* The last task: thieves may be after it too */
+        if (!__atomic_compare_exchange_n(&q->top, &top, top + 1, 0, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) t = NULL;
+        __atomic_store_n(&q->bottom, b + 1, __ATOMIC_RELAXED);
+    }
+    return t;
+}
+
+static __wear_task* __wear_deque_steal(__wear_deque* q) {
+    long long top = __atomic_load_n(&q->top, __ATOMIC_ACQUIRE);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    long long b = __atomic_load_n(&q->bottom, __ATOMIC_ACQUIRE);
+    if (top >= b) return NULL;
+    __wear_ring* r = __atomic_load_n(&q->ring, __ATOMIC_ACQUIRE);
+    __wear_task* t = __wear_ring_get(r, top);
+    if (!__atomic_compare_exchange_n(&q->top, &top, top + 1, 0, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+        return NULL;   /* Lost the race to the owner or another thief */
+    }
+    return t;
+}
+
+/* ---- scheduler ---- */
+
+static void __wear_task_execute(__wear_task* t) {
+    t->run(t);
+    __atomic_store_n(&t->done, 1, __ATOMIC_RELEASE);
+}
+
+/* A task of our own, else one stolen from a victim picked at random */
+static __wear_task* __wear_find_task(int self) {
+    __wear_task* t = __wear_deque_pop(&__wear_deques[self]);
+    if (t != NULL) return t;
+    unsigned int x = __wear_steal_seed;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    __wear_steal_seed = x;
+    for (int k = 0; k < __wear_sched_size; k++) {
+        int victim = (int)((x + k) % (unsigned int)__wear_sched_size);
+        if (victim == self) continue;
+        t = __wear_deque_steal(&__wear_deques[victim]);
+        if (t != NULL) return t;
+    }
+    return NULL;
+}
+
+static int __wear_sched_has_work(void) {
+    for (int k = 0; k < __wear_sched_size; k++) {
+        __wear_deque* q = &__wear_deques[k];
+        if (__atomic_load_n(&q->bottom, __ATOMIC_SEQ_CST) > __atomic_load_n(&q->top, __ATOMIC_SEQ_CST)) return 1;
+    }
+    return 0;
+}
+
+/* Sleep until a push; a push that happened first keeps us awake */
+static void __wear_sched_sleep(void) {
+    pthread_mutex_lock(&__wear_sched_lock);
+    __atomic_add_fetch(&__wear_sched_sleepers, 1, __ATOMIC_SEQ_CST);
+    if (!__wear_sched_has_work()) pthread_cond_wait(&__wear_sched_wake, &__wear_sched_lock);
+    __atomic_sub_fetch(&__wear_sched_sleepers, 1, __ATOMIC_SEQ_CST);
+    pthread_mutex_unlock(&__wear_sched_lock);
+}
+
+static void* __wear_sched_worker(void* arg) {
+    __wear_sched_id = (int)(long)arg;
+    __wear_steal_seed = 2654435761u * (unsigned int)(__wear_sched_id + 1);
+    __wear_pool_inside = 1;   /* urutkan/paralel inside a task run inline */
+    int idle = 0;
+    for (;;) {
+        __wear_task* t = __wear_find_task(__wear_sched_id);
+        if (t != NULL) {
+            __wear_task_execute(t);
+            idle = 0;
+        } else if (++idle >= __WEAR_YIELD_ROUNDS) {
+            __wear_sched_sleep();
+            idle = 0;
+        } else if (idle >= __WEAR_SPIN_ROUNDS) {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+/* Make the calling thread scheduler thread 0 and start the others;
+ * 0 when another thread got there first */
+static int __wear_sched_join(void) {
+    int expected = 0;
+    if (!__atomic_compare_exchange_n(&__wear_sched_started, &expected, 1, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        return 0;
+    }
+    __wear_sched_size = __wear_pool_threads();
+    __wear_deques = (__wear_deque*)calloc(__wear_sched_size, sizeof(__wear_deque));
+    if (__wear_deques == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(1);
+    }
+    for (int k = 0; k < __wear_sched_size; k++) __wear_deques[k].ring = __wear_ring_new(64);
+    __wear_sched_id = 0;
+    __wear_steal_seed = 2654435761u;
+    for (int k = 1; k < __wear_sched_size; k++) {
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, __wear_sched_worker, (void*)(long)k) != 0) break;
+        pthread_detach(thread);
+    }
+    return 1;
+}
+
+/* A task with room for 'size' bytes (the task header included) */
+__wear_task* __wear_task_new(size_t size, void (*run)(__wear_task* t)) {
+    __wear_task* t = (__wear_task*)calloc(1, size);
+    if (t == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(1);
+    }
+    t->run = run;
+    return t;
+}
+
+__wear_task* __wear_task_spawn(__wear_task* t) {
+    if (__wear_sched_id < 0 && !__wear_sched_join()) {
+        __wear_task_execute(t);
+        return t;
+    }
+    __wear_deque_push(&__wear_deques[__wear_sched_id], t);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&__wear_sched_sleepers, __ATOMIC_RELAXED) > 0) {
+        pthread_mutex_lock(&__wear_sched_lock);
+        pthread_cond_signal(&__wear_sched_wake);
+        pthread_mutex_unlock(&__wear_sched_lock);
+    }
+    return t;
+}
+
+static void* __wear_task_thread(void* arg) {
+    __wear_pool_inside = 1;   /* Like scheduler threads, run urutkan/paralel inline */
+    __wear_task_execute((__wear_task*)arg);
+    return NULL;
+}
+
+/* Run a task on a new thread (it may block, e.g. on a channel) */
+__wear_task* __wear_task_start(__wear_task* t) {
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, __wear_task_thread, t) != 0) {
+        fprintf(stderr, "Error: Could not start a thread\n");
+        exit(1);
+    }
+    pthread_detach(thread);
+    return t;
+}
+
+/* jalankan on a value that is no longer a call (e.g. folded at compile time) */
+__wear_task* __wear_task_done_int(int value) {
+    __wear_task* t = __wear_task_new(sizeof(__wear_task), NULL);
+    t->result.i = value;
+    t->done = 1;
+    return t;
+}
+
+__wear_task* __wear_task_done_str(char* value) {
+    __wear_task* t = __wear_task_new(sizeof(__wear_task), NULL);
+    t->result.s = value;
+    t->done = 1;
+    return t;
+}
+
+static void __wear_task_wait(__wear_task* t) {
+    int idle = 0;
+    while (!__atomic_load_n(&t->done, __ATOMIC_ACQUIRE)) {
+        __wear_task* other = __wear_sched_id >= 0 ? __wear_find_task(__wear_sched_id) : NULL;
+        if (other != NULL) {
+            __wear_task_execute(other);
+            idle = 0;
+        } else if (++idle >= __WEAR_SPIN_ROUNDS) {
+            sched_yield();
+        }
+    }
+}
+
+int __wear_tunggu_int(__wear_task* t) {
+    __wear_task_wait(t);
+    return t->result.i;
+}
+
+char* __wear_tunggu_str(__wear_task* t) {
+    __wear_task_wait(t);
+    return t->result.s;
+}
+
+)";
+
+// saluran channels (only emitted when used)
+const char* WEAR_CHANNEL_RUNTIME = R"(
+/* ============================================================
+ * Channels (saluran)
+ * Bounded multi-producer multi-consumer queue (Vyukov): every cell
+ * carries a sequence number telling senders and receivers whose turn
+ * it is, so neither side takes a lock. The capacity is rounded up to
+ * a power of two. Blocked calls spin, then yield, then sleep on a
+ * condition variable that is only signalled while someone sleeps.
+ * After tutup, sends fail and receives drain what is left; a send
+ * racing with tutup either lands before the channel reads as drained
+ * or fails. Tasks that send or receive this way run on threads of
+ * their own (see __wear_task_start).
+ * ============================================================ */
+
+#include <pthread.h>
+#include <sched.h>
+
+#define __WEAR_CHAN_SPIN 64         /* Failed attempts before yielding */
+#define __WEAR_CHAN_YIELD 128       /* ... and before sleeping */
+
+typedef union {
+    int i;
+    char* s;
+} __wear_chan_value;
+
+typedef struct {
+    long long seq;
+    __wear_chan_value value;
+} __wear_chan_cell;
+
+typedef struct {
+    __wear_chan_cell* cells;
+    long long mask;
+    char pad0[48];
+    long long head;                 /* Next cell to send into */
+    char pad1[56];
+    long long tail;                 /* Next cell to receive from */
+    char pad2[56];
+    int closed;
+    int sending;                    /* Sends past the closed check */
+    int sleepers;
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+} __wear_chan;
+
+__wear_chan* __wear_chan_new(int capacity) {
+    long long size = 2;
+    while (size < capacity) size *= 2;
+    __wear_chan* c = (__wear_chan*)calloc(1, sizeof(__wear_chan));
+    __wear_chan_cell* cells = (__wear_chan_cell*)calloc((size_t)size, sizeof(__wear_chan_cell));
+    if (c == NULL || cells == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(1);
+    }
+    for (long long i = 0; i < size; i++) cells[i].seq = i;
+    c->cells = cells;
+    c->mask = size - 1;
+    pthread_mutex_init(&c->lock, NULL);
+    pthread_cond_init(&c->changed, NULL);
+    return c;
+}
+
+static int __wear_chan_push(__wear_chan* c, __wear_chan_value v) {
+    long long pos = __atomic_load_n(&c->head, __ATOMIC_RELAXED);
+    for (;;) {
+        __wear_chan_cell* cell = &c->cells[pos & c->mask];
+        long long turn = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE) - pos;
+        if (turn < 0) return 0;     /* Full */
+        if (turn > 0) {
+            pos = __atomic_load_n(&c->head, __ATOMIC_RELAXED);
+        } else if (__atomic_compare_exchange_n(&c->head, &pos, pos + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            cell->value = v;
+            __atomic_store_n(&cell->seq, pos + 1, __ATOMIC_RELEASE);
+            return 1;
+        }
+    }
+}
+
+static int __wear_chan_pop(__wear_chan* c, __wear_chan_value* v) {
+    long long pos = __atomic_load_n(&c->tail, __ATOMIC_RELAXED);
+    for (;;) {
+        __wear_chan_cell* cell = &c->cells[pos & c->mask];
+        long long turn = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE) - (pos + 1);
+        if (turn < 0) return 0;     /* Empty */
+        if (turn > 0) {
+            pos = __atomic_load_n(&c->tail, __ATOMIC_RELAXED);
+        } else if (__atomic_compare_exchange_n(&c->tail, &pos, pos + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            *v = cell->value;
+            __atomic_store_n(&cell->seq, pos + c->mask + 1, __ATOMIC_RELEASE);
+            return 1;
+        }
+    }
+}
+
+static void __wear_chan_wake(__wear_chan* c) {
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&c->sleepers, __ATOMIC_RELAXED) > 0) {
+        pthread_mutex_lock(&c->lock);
+        pthread_cond_broadcast(&c->changed);
+        pthread_mutex_unlock(&c->lock);
+    }
+}
+
+/* Could a sender (or a receiver) get further than on its last attempt? */
+static int __wear_chan_ready(__wear_chan* c, int sending) {
+    if (__atomic_load_n(&c->closed, __ATOMIC_SEQ_CST)) return 1;
+    long long pos = __atomic_load_n(sending ? &c->head : &c->tail, __ATOMIC_SEQ_CST);
+    long long seq = __atomic_load_n(&c->cells[pos & c->mask].seq, __ATOMIC_SEQ_CST);
+    return seq - pos == (sending ? 0 : 1);
+}
+
+static void __wear_chan_backoff(__wear_chan* c, int sending, int* rounds) {
+    if (++*rounds < __WEAR_CHAN_SPIN) return;
+    if (*rounds < __WEAR_CHAN_YIELD) {
+        sched_yield();
+        return;
+    }
+    pthread_mutex_lock(&c->lock);
+    __atomic_add_fetch(&c->sleepers, 1, __ATOMIC_SEQ_CST);
+    if (!__wear_chan_ready(c, sending)) pthread_cond_wait(&c->changed, &c->lock);
+    __atomic_sub_fetch(&c->sleepers, 1, __ATOMIC_SEQ_CST);
+    pthread_mutex_unlock(&c->lock);
+    *rounds = 0;
+}
+
+/* 1 sent, 0 full (only when not blocking), -1 closed */
+static int __wear_chan_send(__wear_chan* c, __wear_chan_value v, int block) {
+    int rounds = 0;
+    for (;;) {
+        __atomic_add_fetch(&c->sending, 1, __ATOMIC_SEQ_CST);
+        int closed = __atomic_load_n(&c->closed, __ATOMIC_SEQ_CST);
+        int sent = !closed && __wear_chan_push(c, v);
+        __atomic_sub_fetch(&c->sending, 1, __ATOMIC_SEQ_CST);
+        if (closed) return -1;
+        if (sent) {
+            __wear_chan_wake(c);
+            return 1;
+        }
+        if (!block) return 0;
+        __wear_chan_backoff(c, 1, &rounds);
+    }
+}
+
+/* 1 received, 0 empty (only when not blocking), -1 closed and drained */
+static int __wear_chan_recv(__wear_chan* c, __wear_chan_value* v, int block) {
+    int rounds = 0;
+    for (;;) {
+        /* Read these first: a send that follows them sees the channel closed */
+        int closed = __atomic_load_n(&c->closed, __ATOMIC_SEQ_CST);
+        int sending = __atomic_load_n(&c->sending, __ATOMIC_SEQ_CST);
+        if (__wear_chan_pop(c, v)) {
+            __wear_chan_wake(c);
+            return 1;
+        }
+        if (closed && sending == 0) return -1;
+        if (!block) return 0;
+        __wear_chan_backoff(c, 0, &rounds);
+    }
+}
+
+/* kirim / coba_kirim: 1 when sent; kirim blocks while the channel is
+ * full and returns 0 once it is closed (like terima, so it can drive a
+ * selama loop); coba_kirim returns 0 when full and -1 when closed. */
+int __wear_kirim_int(__wear_chan* c, int v) {
+    __wear_chan_value value;
+    value.i = v;
+    return __wear_chan_send(c, value, 1) == 1;
+}
+
+int __wear_kirim_str(__wear_chan* c, char* v) {
+    __wear_chan_value value;
+    value.s = v;
+    return __wear_chan_send(c, value, 1) == 1;
+}
+
+int __wear_coba_kirim_int(__wear_chan* c, int v) {
+    __wear_chan_value value;
+    value.i = v;
+    return __wear_chan_send(c, value, 0);
+}
+
+int __wear_coba_kirim_str(__wear_chan* c, char* v) {
+    __wear_chan_value value;
+    value.s = v;
+    return __wear_chan_send(c, value, 0);
+}
+
+/* terima / coba_terima store into *out and return 1; terima blocks while
+ * the channel is empty and returns 0 once it is closed and drained,
+ * coba_terima returns 0 when empty and -1 when closed and drained. */
+int __wear_terima_int(__wear_chan* c, int* out) {
+    __wear_chan_value value;
+    if (__wear_chan_recv(c, &value, 1) != 1) return 0;
+    *out = value.i;
+    return 1;
+}
+
+int __wear_terima_str(__wear_chan* c, char** out) {
+    __wear_chan_value value;
+    if (__wear_chan_recv(c, &value, 1) != 1) return 0;
+    *out = value.s;
+    return 1;
+}
+
+int __wear_coba_terima_int(__wear_chan* c, int* out) {
+    __wear_chan_value value;
+    int status = __wear_chan_recv(c, &value, 0);
+    if (status == 1) *out = value.i;
+    return status;
+}
+
+int __wear_coba_terima_str(__wear_chan* c, char** out) {
+    __wear_chan_value value;
+    int status = __wear_chan_recv(c, &value, 0);
+    if (status == 1) *out = value.s;
+    return status;
+}
+
+int __wear_tutup(__wear_chan* c) {
+    __atomic_store_n(&c->closed, 1, __ATOMIC_SEQ_CST);
+    pthread_mutex_lock(&c->lock);
+    pthread_cond_broadcast(&c->changed);
+    pthread_mutex_unlock(&c->lock);
+    return 0;
+}
+
+)";
+
+// atomik counters (only emitted when used)
+const char* WEAR_ATOMIC_RUNTIME = R"(
+/* ============================================================
+ * Atomic ints (atomik)
+ * Each one gets a cache line of its own, so counters updated by
+ * different threads do not slow each other down. Loads acquire,
+ * stores release, read-modify-writes do both.
+ * ============================================================ */
+
+typedef struct {
+    int value;
+    char pad[60];
+} __wear_atomic;
+
+__wear_atomic* __wear_atomik(int value) {
+    __wear_atomic* a = (__wear_atomic*)__wear_aligned_alloc(64, sizeof(__wear_atomic));
+    if (a == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(1);
+    }
+    a->value = value;
+    return a;
+}
+
+int __wear_muat(__wear_atomic* a) {
+    return __atomic_load_n(&a->value, __ATOMIC_ACQUIRE);
+}
+
+int __wear_simpan(__wear_atomic* a, int value) {
+    __atomic_store_n(&a->value, value, __ATOMIC_RELEASE);
+    return value;
+}
+
+/* The value before adding */
+int __wear_ambil_tambah(__wear_atomic* a, int delta) {
+    return __atomic_fetch_add(&a->value, delta, __ATOMIC_ACQ_REL);
+}
+
+/* Store 'desired' if the value is 'expected'; 1 when it was */
+int __wear_tukar_jika(__wear_atomic* a, int expected, int desired) {
+    return __atomic_compare_exchange_n(&a->value, &expected, desired, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+
+)";
+
+// baca_banyak (only emitted when used; needs WEAR_POOL_RUNTIME)
+const char* WEAR_FILES_RUNTIME = R"(
+/* ============================================================
+ * Batch file reads (baca_banyak)
+ * Files are opened, read and closed through one io_uring, driven
+ * with raw syscalls: every round submits as many operations as the
+ * ring holds with a single io_uring_enter and collects their
+ * completions, so the disk sees a ring's worth of files at once.
+ * A batch goes through in windows of at most that many files (and
+ * well below RLIMIT_NOFILE), each closed before the next is opened.
+ * Without io_uring (old kernel or headers, seccomp, WEAR_URING=0)
+ * the files are read on the thread pool instead, each worker closing
+ * its file when done. Files that cannot be read give "" and an error
+ * message, as with baca_file.
+ * ============================================================ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#ifndef O_CLOEXEC
+#define O_CLOEXEC 0
+#endif
+#ifndef O_BINARY
+#define O_BINARY 0
+#endif
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#if defined(IORING_FEAT_FAST_POLL) && defined(__NR_io_uring_setup)
+#define __WEAR_URING 1
+#endif
+#endif
+#endif
+
+#define __WEAR_URING_ENTRIES 256
+
+typedef struct {
+    char* path;
+    int fd;             /* -1 once closed */
+    int opened;
+    long size;
+    long done;          /* Bytes read so far */
+    char* data;
+} __wear_file_job;
+
+/* Buffer for an opened file; a file that cannot be sized reads as "" */
+static void __wear_file_opened(__wear_file_job* job, int fd) {
+    struct stat st;
+    job->fd = fd;
+    job->opened = fd >= 0;
+    job->size = fd >= 0 && fstat(fd, &st) == 0 && S_ISREG(st.st_mode) ? (long)st.st_size : 0;
+    job->data = (char*)malloc(job->size + 1);
+    if (job->data == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(1);
+    }
+}
+
+/* The job owns its descriptor, so plain read(), which MinGW has too,
+   continues where the last one stopped */
+static void __wear_file_read_one(void* ctx, int i) {
+    __wear_file_job* job = (__wear_file_job*)ctx + i;
+    __wear_file_opened(job, open(job->path, O_RDONLY | O_CLOEXEC | O_BINARY));
+    while (job->fd >= 0 && job->done < job->size) {
+        ssize_t n = read(job->fd, job->data + job->done, job->size - job->done);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        job->done += n;
+    }
+    if (job->fd >= 0) close(job->fd);
+    job->fd = -1;
+}
+
+#ifdef __WEAR_URING
+typedef struct {
+    int fd;
+    unsigned entries;
+    unsigned *sq_head, *sq_tail, *sq_mask, *sq_array;
+    unsigned *cq_head, *cq_tail, *cq_mask;
+    struct io_uring_sqe* sqes;
+    struct io_uring_cqe* cqes;
+    unsigned queued;    /* Prepared since the last io_uring_enter */
+} __wear_uring;
+
+static __wear_uring __wear_uring_shared;
+static int __wear_uring_state = 0;         /* 0 not tried, 1 ready, -1 unavailable */
+static pthread_mutex_t __wear_uring_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static int __wear_uring_setup(__wear_uring* r) {
+    const char* env = getenv("WEAR_URING");
+    if (env != NULL && strcmp(env, "0") == 0) return 0;
+    struct io_uring_params p;
+    memset(&p, 0, sizeof(p));
+    int fd = (int)syscall(__NR_io_uring_setup, __WEAR_URING_ENTRIES, &p);
+    if (fd < 0) return 0;
+    /* FAST_POLL came with 5.7, after IORING_OP_OPENAT and IORING_OP_READ */
+    if (!(p.features & IORING_FEAT_FAST_POLL)) {
+        close(fd);
+        return 0;
+    }
+    size_t sq_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    size_t cq_size = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    char* sq = (char*)mmap(NULL, sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                           IORING_OFF_SQ_RING);
+    char* cq = (char*)mmap(NULL, cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                           IORING_OFF_CQ_RING);
+    void* sqes = mmap(NULL, p.sq_entries * sizeof(struct io_uring_sqe), PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (sq == MAP_FAILED || cq == MAP_FAILED || sqes == MAP_FAILED) {
+        close(fd);
+        return 0;
+    }
+    r->fd = fd;
+    r->entries = p.sq_entries;
+    r->sq_head = (unsigned*)(sq + p.sq_off.head);
+    r->sq_tail = (unsigned*)(sq + p.sq_off.tail);
+    r->sq_mask = (unsigned*)(sq + p.sq_off.ring_mask);
+    r->sq_array = (unsigned*)(sq + p.sq_off.array);
+    r->cq_head = (unsigned*)(cq + p.cq_off.head);
+    r->cq_tail = (unsigned*)(cq + p.cq_off.tail);
+    r->cq_mask = (unsigned*)(cq + p.cq_off.ring_mask);
+    r->sqes = (struct io_uring_sqe*)sqes;
+    r->cqes = (struct io_uring_cqe*)(cq + p.cq_off.cqes);
+    r->queued = 0;
+    return 1;
+}
+
+/* The next submission entry, zeroed; published by __wear_uring_enter */
+static struct io_uring_sqe* __wear_uring_sqe(__wear_uring* r, int job) {
+    unsigned tail = *r->sq_tail + r->queued;
+    unsigned index = tail & *r->sq_mask;
+    struct io_uring_sqe* sqe = &r->sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->user_data = (unsigned long long)job;
+    r->sq_array[index] = index;
+    r->queued++;
+    return sqe;
+}
+
+/* Submit what is queued and wait for at least one completion */
+static void __wear_uring_enter(__wear_uring* r) {
+    unsigned submit = r->queued;
+    __atomic_store_n(r->sq_tail, *r->sq_tail + submit, __ATOMIC_RELEASE);
+    r->queued = 0;
+    for (;;) {
+        long done = syscall(__NR_io_uring_enter, r->fd, submit, 1, IORING_ENTER_GETEVENTS, NULL, 0);
+        if (done >= 0) {
+            submit -= (unsigned)done;
+            if (submit == 0) return;
+        } else if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+            fprintf(stderr, "Error: io_uring_enter failed (%s)\n", strerror(errno));
+            exit(1);
+        }
+    }
+}
+
+static void __wear_uring_prep_read(__wear_uring* r, __wear_file_job* jobs, int i) {
+    long left = jobs[i].size - jobs[i].done;
+    struct io_uring_sqe* sqe = __wear_uring_sqe(r, i);
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = jobs[i].fd;
+    sqe->addr = (unsigned long long)(jobs[i].data + jobs[i].done);
+    sqe->len = left > (1L << 30) ? 1U << 30 : (unsigned)left;
+    sqe->off = (unsigned long long)jobs[i].done;
+}
+
+/* Phase 0 opens every file, phase 1 reads and phase 2 closes every opened
+   one. Short reads are continued from the completion; in flight never
+   exceeds the ring */
+static void __wear_uring_phase(__wear_uring* r, __wear_file_job* jobs, int count, int phase) {
+    int next = 0;
+    unsigned inflight = 0;
+    for (;;) {
+        while (next < count && inflight + r->queued < r->entries) {
+            __wear_file_job* job = &jobs[next];
+            if (phase == 0) {
+                struct io_uring_sqe* sqe = __wear_uring_sqe(r, next);
+                sqe->opcode = IORING_OP_OPENAT;
+                sqe->fd = AT_FDCWD;
+                sqe->addr = (unsigned long long)job->path;
+                sqe->open_flags = O_RDONLY | O_CLOEXEC;
+            } else if (phase == 1 && job->fd >= 0 && job->size > 0) {
+                __wear_uring_prep_read(r, jobs, next);
+            } else if (phase == 2 && job->fd >= 0) {
+                struct io_uring_sqe* sqe = __wear_uring_sqe(r, next);
+                sqe->opcode = IORING_OP_CLOSE;
+                sqe->fd = job->fd;
+            }
+            next++;
+        }
+        inflight += r->queued;
+        if (inflight == 0) return;
+        __wear_uring_enter(r);
+        
+        unsigned head = *r->cq_head;
+        while (head != __atomic_load_n(r->cq_tail, __ATOMIC_ACQUIRE)) {
+            struct io_uring_cqe* cqe = &r->cqes[head & *r->cq_mask];
+            int i = (int)cqe->user_data;
+            int res = cqe->res;
+            head++;
+            inflight--;
+            if (phase == 0) {
+                __wear_file_opened(&jobs[i], res);
+            } else if (phase == 2) {
+                jobs[i].fd = -1;
+            } else if (res == -EINTR || res == -EAGAIN) {
+                __wear_uring_prep_read(r, jobs, i);
+            } else if (res > 0) {
+                jobs[i].done += res;
+                if (jobs[i].done < jobs[i].size) __wear_uring_prep_read(r, jobs, i);
+            }
+        }
+        __atomic_store_n(r->cq_head, head, __ATOMIC_RELEASE);
+    }
+}
+
+/* Files open at once: the ring size, and at most half the descriptors
+   the process may still have (the program may hold some itself) */
+static int __wear_uring_window(__wear_uring* r) {
+    int window = (int)r->entries;
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur != RLIM_INFINITY &&
+        limit.rlim_cur / 2 < (rlim_t)window) {
+        window = limit.rlim_cur / 2 > 0 ? (int)(limit.rlim_cur / 2) : 1;
+    }
+    return window;
+}
+#endif
+
+static char __wear_no_path[] = "";
+
+/* Contents of every file in 'paths' (kind 1 strings, 2 views), in order */
+__wear_array* __wear_baca_banyak(__wear_array* paths, int kind) {
+    int count = paths->length;
+    __wear_file_job* jobs = (__wear_file_job*)calloc(count > 0 ? count : 1, sizeof(__wear_file_job));
+    if (jobs == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(1);
+    }
+    for (int i = 0; i < count; i++) {
+        void* item = paths->data + (size_t)i * paths->elem_size;
+        char* path = kind == 2 ? __wear_view_str(*(__wear_view*)item) : *(char**)item;
+        jobs[i].path = path != NULL ? path : __wear_no_path;
+        jobs[i].fd = -1;
+    }
+    
+    int ring = 0;
+#ifdef __WEAR_URING
+    if (count > 1) {
+        pthread_mutex_lock(&__wear_uring_lock);
+        if (__wear_uring_state == 0) __wear_uring_state = __wear_uring_setup(&__wear_uring_shared) ? 1 : -1;
+        ring = __wear_uring_state == 1;
+        if (ring) {
+            int window = __wear_uring_window(&__wear_uring_shared);
+            for (int start = 0; start < count; start += window) {
+                int n = count - start < window ? count - start : window;
+                for (int phase = 0; phase < 3; phase++) {
+                    __wear_uring_phase(&__wear_uring_shared, jobs + start, n, phase);
+                }
+            }
+        }
+        pthread_mutex_unlock(&__wear_uring_lock);
+    }
+#endif
+    if (!ring) __wear_pool_run(count, __wear_file_read_one, jobs);
+    
+    __wear_array* contents = __wear_array_new(count, sizeof(char*));
+    for (int i = 0; i < count; i++) {
+        __wear_file_job* job = &jobs[i];
+        if (!job->opened) fprintf(stderr, "Error: Cannot open file '%s'\n", job->path);
+        job->data[job->done] = '\0';
+        ((char**)contents->data)[i] = job->data;
+        if (kind == 2) free(job->path);
+    }
+    free(jobs);
+    return contents;
+}
+
+)";
+
+// Int array builtins (only emitted when used)
+const char* WEAR_VECTOR_RUNTIME = R"(
+/* ============================================================
+ * Int array kernels (jumlah, maks, min, hitung_jika, tambah_semua,
+ * kali_semua)
+ * A chain of tambah_semua/kali_semua arrives as a list of steps that
+ * is folded into one map x * mul + add (wrapping like int arithmetic),
+ * so a chain ending in a reduction reads the array once and builds no
+ * arrays in between. Kernels come in AVX2, SSE4.1 and scalar versions;
+ * the best one the CPU supports is picked at startup (WEAR_SIMD=sse4.1
+ * or WEAR_SIMD=scalar caps it).
+ * ============================================================ */
+
+typedef struct {
+    unsigned int mul;
+    unsigned int add;
+} __wear_affine;
+
+#define __WEAR_AFFINE(x, f) ((int)((unsigned int)(x) * (f).mul + (f).add))
+
+/* steps holds 'count' pairs: (0, v) adds v, (1, v) multiplies by v */
+static __wear_affine __wear_affine_of(const int* steps, int count) {
+    __wear_affine f = {1u, 0u};
+    for (int i = 0; i < count; i++) {
+        unsigned int v = (unsigned int)steps[2 * i + 1];
+        if (steps[2 * i] == 0) {
+            f.add += v;
+        } else {
+            f.mul *= v;
+            f.add *= v;
+        }
+    }
+    return f;
+}
+
+typedef struct {
+    unsigned int (*sum)(const int* x, int n);
+    int (*max)(const int* x, int n, __wear_affine f);     /* n >= 1 */
+    int (*min)(const int* x, int n, __wear_affine f);     /* n >= 1 */
+    /* Mapped elements greater than / equal to value */
+    void (*count)(const int* x, int n, __wear_affine f, int value, int* greater, int* equal);
+    void (*map)(const int* x, int* out, int n, __wear_affine f);
+} __wear_int_kernels;
+
+/* ---- scalar ---- */
+
+static unsigned int __wear_sum_scalar(const int* x, int n) {
+    unsigned int s = 0;
+    for (int i = 0; i < n; i++) s += (unsigned int)x[i];
+    return s;
+}
+
+static int __wear_max_scalar(const int* x, int n, __wear_affine f) {
+    int best = __WEAR_AFFINE(x[0], f);
+    for (int i = 1; i < n; i++) {
+        int y = __WEAR_AFFINE(x[i], f);
+        if (y > best) best = y;
+    }
+    return best;
+}
+
+static int __wear_min_scalar(const int* x, int n, __wear_affine f) {
+    int best = __WEAR_AFFINE(x[0], f);
+    for (int i = 1; i < n; i++) {
+        int y = __WEAR_AFFINE(x[i], f);
+        if (y < best) best = y;
+    }
+    return best;
+}
+
+static void __wear_count_scalar(const int* x, int n, __wear_affine f, int value, int* greater, int* equal) {
+    int g = 0, e = 0;
+    for (int i = 0; i < n; i++) {
+        int y = __WEAR_AFFINE(x[i], f);
+        g += y > value;
+        e += y == value;
+    }
+    *greater = g;
+    *equal = e;
+}
+
+static void __wear_map_scalar(const int* x, int* out, int n, __wear_affine f) {
+    for (int i = 0; i < n; i++) out[i] = __WEAR_AFFINE(x[i], f);
+}
+
+static __wear_int_kernels __wear_kernels = {
+    __wear_sum_scalar, __wear_max_scalar, __wear_min_scalar, __wear_count_scalar, __wear_map_scalar
+};
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+
+/* ---- SSE4.1 (4 lanes) ---- */
+
+__attribute__((target("sse4.1")))
+static unsigned int __wear_sum_sse(const int* x, int n) {
+    __m128i acc = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 4 <= n; i += 4) acc = _mm_add_epi32(acc, _mm_loadu_si128((const __m128i*)(x + i)));
+    unsigned int lanes[4];
+    _mm_storeu_si128((__m128i*)lanes, acc);
+    unsigned int s = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    for (; i < n; i++) s += (unsigned int)x[i];
+    return s;
+}
+
+__attribute__((target("sse4.1")))
+static int __wear_max_sse(const int* x, int n, __wear_affine f) {
+    __m128i mul = _mm_set1_epi32((int)f.mul), add = _mm_set1_epi32((int)f.add);
+    int best = __WEAR_AFFINE(x[0], f);
+    __m128i acc = _mm_set1_epi32(best);
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i y = _mm_add_epi32(_mm_mullo_epi32(_mm_loadu_si128((const __m128i*)(x + i)), mul), add);
+        acc = _mm_max_epi32(acc, y);
+    }
+    int lanes[4];
+    _mm_storeu_si128((__m128i*)lanes, acc);
+    for (int k = 0; k < 4; k++) if (lanes[k] > best) best = lanes[k];
+    for (; i < n; i++) if (__WEAR_AFFINE(x[i], f) > best) best = __WEAR_AFFINE(x[i], f);
+    return best;
+}
+
+__attribute__((target("sse4.1")))
+static int __wear_min_sse(const int* x, int n, __wear_affine f) {
+    __m128i mul = _mm_set1_epi32((int)f.mul), add = _mm_set1_epi32((int)f.add);
+    int best = __WEAR_AFFINE(x[0], f);
+    __m128i acc = _mm_set1_epi32(best);
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i y = _mm_add_epi32(_mm_mullo_epi32(_mm_loadu_si128((const __m128i*)(x + i)), mul), add);
+        acc = _mm_min_epi32(acc, y);
+    }
+    int lanes[4];
+    _mm_storeu_si128((__m128i*)lanes, acc);
+    for (int k = 0; k < 4; k++) if (lanes[k] < best) best = lanes[k];
+    for (; i < n; i++) if (__WEAR_AFFINE(x[i], f) < best) best = __WEAR_AFFINE(x[i], f);
+    return best;
+}
+
+__attribute__((target("sse4.1")))
+static void __wear_count_sse(const int* x, int n, __wear_affine f, int value, int* greater, int* equal) {
+    __m128i mul = _mm_set1_epi32((int)f.mul), add = _mm_set1_epi32((int)f.add);
+    __m128i v = _mm_set1_epi32(value);
+    __m128i g = _mm_setzero_si128(), e = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i y = _mm_add_epi32(_mm_mullo_epi32(_mm_loadu_si128((const __m128i*)(x + i)), mul), add);
+        g = _mm_sub_epi32(g, _mm_cmpgt_epi32(y, v));   /* Matching lanes are -1 */
+        e = _mm_sub_epi32(e, _mm_cmpeq_epi32(y, v));
+    }
+    int gl[4], el[4];
+    _mm_storeu_si128((__m128i*)gl, g);
+    _mm_storeu_si128((__m128i*)el, e);
+    int gs = gl[0] + gl[1] + gl[2] + gl[3], es = el[0] + el[1] + el[2] + el[3];
+    for (; i < n; i++) {
+        int y = __WEAR_AFFINE(x[i], f);
+        gs += y > value;
+        es += y == value;
+    }
+    *greater = gs;
+    *equal = es;
+}
+
+__attribute__((target("sse4.1")))
+static void __wear_map_sse(const int* x, int* out, int n, __wear_affine f) {
+    __m128i mul = _mm_set1_epi32((int)f.mul), add = _mm_set1_epi32((int)f.add);
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i y = _mm_add_epi32(_mm_mullo_epi32(_mm_loadu_si128((const __m128i*)(x + i)), mul), add);
+        _mm_storeu_si128((__m128i*)(out + i), y);
+    }
+    for (; i < n; i++) out[i] = __WEAR_AFFINE(x[i], f);
+}
+
+/* ---- AVX2 (8 lanes) ---- */
+
+__attribute__((target("avx2")))
+static unsigned int __wear_sum_avx2(const int* x, int n) {
+    __m256i a = _mm256_setzero_si256(), b = _mm256_setzero_si256();
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        a = _mm256_add_epi32(a, _mm256_loadu_si256((const __m256i*)(x + i)));
+        b = _mm256_add_epi32(b, _mm256_loadu_si256((const __m256i*)(x + i + 8)));
+    }
+    unsigned int lanes[8];
+    _mm256_storeu_si256((__m256i*)lanes, _mm256_add_epi32(a, b));
+    unsigned int s = 0;
+    for (int k = 0; k < 8; k++) s += lanes[k];
+    for (; i < n; i++) s += (unsigned int)x[i];
+    return s;
+}
+
+__attribute__((target("avx2")))
+static int __wear_max_avx2(const int* x, int n, __wear_affine f) {
+    __m256i mul = _mm256_set1_epi32((int)f.mul), add = _mm256_set1_epi32((int)f.add);
+    int best = __WEAR_AFFINE(x[0], f);
+    __m256i acc = _mm256_set1_epi32(best);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i y = _mm256_add_epi32(_mm256_mullo_epi32(_mm256_loadu_si256((const __m256i*)(x + i)), mul), add);
+        acc = _mm256_max_epi32(acc, y);
+    }
+    int lanes[8];
+    _mm256_storeu_si256((__m256i*)lanes, acc);
+    for (int k = 0; k < 8; k++) if (lanes[k] > best) best = lanes[k];
+    for (; i < n; i++) if (__WEAR_AFFINE(x[i], f) > best) best = __WEAR_AFFINE(x[i], f);
+    return best;
+}
+
+__attribute__((target("avx2")))
+static int __wear_min_avx2(const int* x, int n, __wear_affine f) {
+    __m256i mul = _mm256_set1_epi32((int)f.mul), add = _mm256_set1_epi32((int)f.add);
+    int best = __WEAR_AFFINE(x[0], f);
+    __m256i acc = _mm256_set1_epi32(best);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i y = _mm256_add_epi32(_mm256_mullo_epi32(_mm256_loadu_si256((const __m256i*)(x + i)), mul), add);
+        acc = _mm256_min_epi32(acc, y);
+    }
+    int lanes[8];
+    _mm256_storeu_si256((__m256i*)lanes, acc);
+    for (int k = 0; k < 8; k++) if (lanes[k] < best) best = lanes[k];
+    for (; i < n; i++) if (__WEAR_AFFINE(x[i], f) < best) best = __WEAR_AFFINE(x[i], f);
+    return best;
+}
+
+__attribute__((target("avx2")))
+static void __wear_count_avx2(const int* x, int n, __wear_affine f, int value, int* greater, int* equal) {
+    __m256i mul = _mm256_set1_epi32((int)f.mul), add = _mm256_set1_epi32((int)f.add);
+    __m256i v = _mm256_set1_epi32(value);
+    __m256i g = _mm256_setzero_si256(), e = _mm256_setzero_si256();
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i y = _mm256_add_epi32(_mm256_mullo_epi32(_mm256_loadu_si256((const __m256i*)(x + i)), mul), add);
+        g = _mm256_sub_epi32(g, _mm256_cmpgt_epi32(y, v));
+        e = _mm256_sub_epi32(e, _mm256_cmpeq_epi32(y, v));
+    }
+    int gl[8], el[8];
+    _mm256_storeu_si256((__m256i*)gl, g);
+    _mm256_storeu_si256((__m256i*)el, e);
+    int gs = 0, es = 0;
+    for (int k = 0; k < 8; k++) {
+        gs += gl[k];
+        es += el[k];
+    }
+    for (; i < n; i++) {
+        int y = __WEAR_AFFINE(x[i], f);
+        gs += y > value;
+        es += y == value;
+    }
+    *greater = gs;
+    *equal = es;
+}
+
+__attribute__((target("avx2")))
+static void __wear_map_avx2(const int* x, int* out, int n, __wear_affine f) {
+    __m256i mul = _mm256_set1_epi32((int)f.mul), add = _mm256_set1_epi32((int)f.add);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i y = _mm256_add_epi32(_mm256_mullo_epi32(_mm256_loadu_si256((const __m256i*)(x + i)), mul), add);
+        _mm256_storeu_si256((__m256i*)(out + i), y);
+    }
+    for (; i < n; i++) out[i] = __WEAR_AFFINE(x[i], f);
+}
+
+__attribute__((constructor))
+static void __wear_pick_kernels(void) {
+    const char* cap = getenv("WEAR_SIMD");
+    int scalar = cap != NULL && strcmp(cap, "scalar") == 0;
+    int sse = cap != NULL && strcmp(cap, "sse4.1") == 0;
+    __builtin_cpu_init();
+    if (!scalar && !sse && __builtin_cpu_supports("avx2")) {
+        __wear_int_kernels k = {__wear_sum_avx2, __wear_max_avx2, __wear_min_avx2, __wear_count_avx2, __wear_map_avx2};
+        __wear_kernels = k;
+    } else if (!scalar && __builtin_cpu_supports("sse4.1")) {
+        __wear_int_kernels k = {__wear_sum_sse, __wear_max_sse, __wear_min_sse, __wear_count_sse, __wear_map_sse};
+        __wear_kernels = k;
+    }
+}
+#endif
+
+static void __wear_need_elements(__wear_array* a, const char* name) {
+    if (a->length == 0) {
+        fprintf(stderr, "Error: %s of an empty array\n", name);
+        exit(1);
+    }
+}
+
+/* jumlah: sum(x * mul + add) = mul * sum(x) + n * add, exact under wrapping */
+int __wear_jumlah(__wear_array* a, const int* steps, int count) {
+    __wear_affine f = __wear_affine_of(steps, count);
+    unsigned int s = __wear_kernels.sum((const int*)a->data, a->length);
+    return (int)(s * f.mul + (unsigned int)a->length * f.add);
+}
+
+int __wear_maks(__wear_array* a, const int* steps, int count) {
+    __wear_need_elements(a, "maks");
+    return __wear_kernels.max((const int*)a->data, a->length, __wear_affine_of(steps, count));
+}
+
+int __wear_min(__wear_array* a, const int* steps, int count) {
+    __wear_need_elements(a, "min");
+    return __wear_kernels.min((const int*)a->data, a->length, __wear_affine_of(steps, count));
+}
+
+/* hitung_jika (test: 0 '>', 1 '<', 2 '==', 3 '<=', 4 '>=', 5 '!=') */
+int __wear_hitung_jika(__wear_array* a, const int* steps, int count, int test, int value) {
+    int g, e;
+    int n = a->length;
+    __wear_kernels.count((const int*)a->data, n, __wear_affine_of(steps, count), value, &g, &e);
+    switch (test) {
+        case 0: return g;
+        case 1: return n - g - e;
+        case 2: return e;
+        case 3: return n - g;
+        case 4: return g + e;
+        default: return n - e;
+    }
+}
+
+/* tambah_semua/kali_semua: a new array; the argument is left alone */
+__wear_array* __wear_map_int(__wear_array* a, const int* steps, int count) {
+    __wear_array* out = __wear_array_new(a->length, sizeof(int));
+    __wear_kernels.map((const int*)a->data, (int*)out->data, a->length, __wear_affine_of(steps, count));
+    return out;
+}
+
+)";
+
+// ============================================================
+// Token Types
+// ============================================================
+
+enum class TokenType {
+    // Keywords
+    VAR,
+    CETAK,      // print
+    SELAMA,     // while
+    JIKA,       // if
+    LAINNYA,    // else
+    FUNGSI,     // function
+    KEMBALIKAN, // return
+    IMPOR,      // import
+    BACA_FILE,  // read_file
+    TULIS_FILE, // write_file
+    SAMA,       // string equality
+    PANJANG,    // string length
+    CHAR_AT,    // character at index
+    IS_QUOTE,   // check if character is quote
+    QUOTE_CHAR, // get quote character
+    IS_NEWLINE, // check if character is newline
+    NEWLINE_CHAR, // get newline character
+    KODE_AT,    // byte at index as int
+    IS_DIGIT_KODE,  // check if byte code is digit
+    IS_LETTER_KODE, // check if byte code is letter
+    POTONG,     // substring view
+    PISAH,      // split into an array of views
+    COCOK,      // regular expression match
+    URUTKAN,    // sort an array in place
+    PARALEL,    // parallel counted loop
+    JALANKAN,   // spawn a task
+    TUNGGU,     // wait for a task
+    HASILKAN,   // yield a value from a generator
+    UNTUK,      // iterate a generator
+    
+    // Literals
+    INTEGER,
+    STRING,
+    IDENTIFIER,
+    ANNOTATION, // @name before 'fungsi'
+    REGEX,      // /pattern/ (text between the slashes)
+    
+    // Operators
+    PLUS,
+    MINUS,
+    STAR,
+    SLASH,
+    EQUAL,
+    LESS,
+    GREATER,
+    LESS_EQUAL,
+    GREATER_EQUAL,
+    EQUAL_EQUAL,
+    NOT_EQUAL,
+    QUESTION,   // conditional expression (produced by the inliner)
+    
+    // Delimiters
+    LPAREN,
+    RPAREN,
+    LBRACE,
+    RBRACE,
+    LBRACKET,
+    RBRACKET,
+    SEMICOLON,
+    COLON,      // type annotation separator
+    COMMA,
+    NEWLINE,    // Line terminator
+    
+    // Special
+    END_OF_FILE,
+    UNKNOWN
+};
+
+// ============================================================
+// Token Structure
+// ============================================================
+
+struct Token {
+    TokenType type;
+    std::string value;
+    int line;
+    int column;
+    int file = 0;   // Index into ModuleLoader::files
+    
+    Token(TokenType t, const std::string& v, int l, int c)
+        : type(t), value(v), line(l), column(c) {}
+};
+
+// ============================================================
+// Compiler threads
+// ============================================================
+
+// Threads the compiler itself uses: WEAR_THREADS, as for compiled
+// programs, or one per CPU
+unsigned compilerThreads() {
+    const char* env = std::getenv("WEAR_THREADS");
+    long n = env != nullptr ? std::atol(env) : (long)std::thread::hardware_concurrency();
+    return n < 1 ? 1 : n > 256 ? 256 : (unsigned)n;
+}
+
+// Call fn(i) for every i in [0, tasks), spread over compilerThreads()
+// threads; returns when all calls have finished
+template <typename F>
+void runParallel(size_t tasks, const F& fn) {
+    size_t threads = std::min<size_t>(compilerThreads(), tasks);
+    if (threads < 2) {
+        for (size_t i = 0; i < tasks; i++) fn(i);
+        return;
+    }
+    std::atomic<size_t> next(0);
+    auto work = [&]() {
+        for (size_t i = next++; i < tasks; i = next++) fn(i);
+    };
+    std::vector<std::thread> pool;
+    for (size_t t = 1; t < threads; t++) pool.emplace_back(work);
+    work();
+    for (auto& thread : pool) thread.join();
+}
+
+// ============================================================
+// Lexer
+// ============================================================
+
+class Lexer {
+private:
+    std::string source;
+    size_t pos = 0;
+    int line = 1;
+    int column = 1;
+    bool openString = false;    // The source ended inside a string literal
+    size_t openStringStart = 0; // ... which opened here
+    
+    std::unordered_map<std::string, TokenType> keywords;
+    
+    char current() const {
+        return pos < source.length() ? source[pos] : '\0';
+    }
+    
+    char peek(int offset = 1) const {
+        size_t idx = pos + offset;
+        return idx < source.length() ? source[idx] : '\0';
+    }
+    
+    void advance() {
+        if (current() == '\n') {
+            line++;
+            column = 1;
+        } else {
+            column++;
+        }
+        pos++;
+    }
+    
+    void skipWhitespace() {
+        // Skip spaces and tabs, but NOT newlines (they're significant)
+        while (current() == ' ' || current() == '\t' || current() == '\r') {
+            advance();
+        }
+    }
+    
+    void skipLineComment() {
+        while (current() != '\n' && current() != '\0') {
+            advance();
+        }
+    }
+    
+    Token scanString() {
+        int startLine = line;
+        int startCol = column;
+        size_t start = pos;
+        advance(); // skip opening quote
+        
+        std::string value;
+        while (current() != '"' && current() != '\0') {
+            if (current() == '\\' && peek() == '"') {
+                advance();
+                value += '"';
+            } else if (current() == '\\' && peek() == 'n') {
+                advance();
+                advance();
+                value += "\\n";
+            } else {
+                value += current();
+                advance();
+            }
+        }
+        
+        if (current() == '"') {
+            advance(); // skip closing quote
+        } else {
+            openString = true;
+            openStringStart = start;
+        }
+        
+        return Token(TokenType::STRING, value, startLine, startCol);
+    }
+    
+    // Closing '/' of a pattern literal starting at pos (escapes and '/'
+    // inside [...] do not end it), or 0 when the line has none
+    size_t regexEnd() const {
+        bool inClass = false;
+        for (size_t i = pos + 1; i < source.length() && source[i] != '\n'; i++) {
+            if (source[i] == '\\') {
+                i++;
+            } else if (source[i] == '[') {
+                inClass = true;
+            } else if (source[i] == ']') {
+                inClass = false;
+            } else if (source[i] == '/' && !inClass) {
+                return i;
+            }
+        }
+        return 0;
+    }
+    
+    Token scanRegex(size_t end) {
+        Token tok(TokenType::REGEX, source.substr(pos + 1, end - pos - 1), line, column);
+        while (pos <= end) advance();
+        return tok;
+    }
+    
+    Token scanNumber() {
+        int startLine = line;
+        int startCol = column;
+        std::string value;
+        
+        while (std::isdigit(current())) {
+            value += current();
+            advance();
+        }
+        
+        return Token(TokenType::INTEGER, value, startLine, startCol);
+    }
+    
+    Token scanIdentifier() {
+        int startLine = line;
+        int startCol = column;
+        std::string value;
+        
+        while (std::isalnum(current()) || current() == '_') {
+            value += current();
+            advance();
+        }
+        
+        auto it = keywords.find(value);
+        if (it != keywords.end()) {
+            return Token(it->second, value, startLine, startCol);
+        }
+        
+        return Token(TokenType::IDENTIFIER, value, startLine, startCol);
+    }
+
+    // Where scanString ends a string opening at 'start': just past the
+    // next quote (a backslash before it does not keep the string open),
+    // or the end of the source
+    size_t stringEnd(size_t start) const {
+        size_t close = source.find('"', start + 1);
+        return close == std::string::npos ? source.length() : close + 1;
+    }
+    
+    // Line and column of source[offset]
+    std::pair<int, int> positionOf(size_t offset) const {
+        int lines = 1 + (int)std::count(source.begin(), source.begin() + offset, '\n');
+        size_t lineStart = source.rfind('\n', offset == 0 ? std::string::npos : offset - 1);
+        lineStart = lineStart == std::string::npos || offset == 0 ? 0 : lineStart + 1;
+        return {lines, (int)(offset - lineStart) + 1};
+    }
+    
+    // Sources this large are lexed on several threads
+    static const size_t parallelMinBytes = 1 << 20;
+    static const size_t parallelMinChunk = 1 << 18;
+    
+    // Lex 'source' in chunks that start at line starts, all at once. A
+    // chunk is lexed assuming it does not start inside a string; strings
+    // are the only tokens that span lines, so that holds unless the chunk
+    // before ends in an unterminated string. Such a string is lexed again
+    // from its opening quote, up to the first chunk boundary past its end,
+    // and the chunks in between are dropped. Regex literals need no fix-up:
+    // after a newline, as at the start of a chunk, '/' is never one.
+    std::vector<Token> tokenizeParallel(size_t chunks) {
+        std::vector<size_t> bounds = {0};
+        for (size_t k = 1; k < chunks; k++) {
+            size_t cut = source.find('\n', std::max(bounds.back(), source.length() / chunks * k));
+            if (cut == std::string::npos || cut + 1 >= source.length()) break;
+            bounds.push_back(cut + 1);
+        }
+        bounds.push_back(source.length());
+        chunks = bounds.size() - 1;
+        
+        std::vector<int> firstLines(chunks, 1);
+        for (size_t k = 1; k < chunks; k++) {
+            firstLines[k] = firstLines[k - 1] +
+                            (int)std::count(source.begin() + bounds[k - 1], source.begin() + bounds[k], '\n');
+        }
+        
+        struct Chunk {
+            std::vector<Token> tokens;
+            bool open = false;
+            size_t openStart = 0;
+        };
+        std::vector<Chunk> parts(chunks);
+        runParallel(chunks, [&](size_t k) {
+            Lexer part(source.substr(bounds[k], bounds[k + 1] - bounds[k]), firstLines[k]);
+            part.scan(parts[k].tokens);
+            parts[k].open = part.openString;
+            parts[k].openStart = bounds[k] + part.openStringStart;
+        });
+        
+        std::vector<Token> tokens;
+        for (size_t k = 0; k < chunks;) {
+            tokens.insert(tokens.end(), parts[k].tokens.begin(), parts[k].tokens.end());
+            bool open = parts[k].open;
+            size_t openStart = parts[k].openStart;
+            k++;
+            while (open && k < chunks) {
+                tokens.pop_back();   // The string, cut off at the chunk end
+                size_t end = stringEnd(openStart);
+                while (k < chunks && bounds[k] < end) k++;
+                auto at = positionOf(openStart);
+                Lexer again(source.substr(openStart, bounds[k] - openStart), at.first, at.second);
+                again.scan(tokens);
+                open = again.openString;
+                openStart += again.openStringStart;
+            }
+        }
+        
+        auto end = positionOf(source.length());
+        tokens.push_back(Token(TokenType::END_OF_FILE, "", end.first, end.second));
+        return tokens;
+    }
+
+public:
+    explicit Lexer(const std::string& src, int firstLine = 1, int firstColumn = 1)
+        : source(src), line(firstLine), column(firstColumn) {
+        // Indonesian keywords
+        keywords["var"] = TokenType::VAR;
         keywords["cetak"] = TokenType::CETAK;
         keywords["selama"] = TokenType::SELAMA;
         keywords["jika"] = TokenType::JIKA;
         keywords["lainnya"] = TokenType::LAINNYA;
         keywords["fungsi"] = TokenType::FUNGSI;
         keywords["kembalikan"] = TokenType::KEMBALIKAN;
+        keywords["impor"] = TokenType::IMPOR;
         keywords["baca_file"] = TokenType::BACA_FILE;
         keywords["tulis_file"] = TokenType::TULIS_FILE;
         
-        // English keywords (aliases)
-        keywords["print"] = TokenType::CETAK;
-        keywords["while"] = TokenType::SELAMA;
-        keywords["if"] = TokenType::JIKA;
-        keywords["else"] = TokenType::LAINNYA;
-        keywords["function"] = TokenType::FUNGSI;
-        keywords["return"] = TokenType::KEMBALIKAN;
-        keywords["read_file"] = TokenType::BACA_FILE;
-        keywords["write_file"] = TokenType::TULIS_FILE;
-        keywords["sama"] = TokenType::SAMA;
-        keywords["panjang"] = TokenType::PANJANG;
-        keywords["char_at"] = TokenType::CHAR_AT;
-        keywords["is_quote"] = TokenType::IS_QUOTE;
-        keywords["quote_char"] = TokenType::QUOTE_CHAR;
-        keywords["is_newline"] = TokenType::IS_NEWLINE;
-        keywords["newline_char"] = TokenType::NEWLINE_CHAR;
-        keywords["streq"] = TokenType::SAMA;      // English alias
-        keywords["strlen"] = TokenType::PANJANG;  // English alias
+        // English keywords (aliases)
+        keywords["print"] = TokenType::CETAK;
+        keywords["while"] = TokenType::SELAMA;
+        keywords["if"] = TokenType::JIKA;
+        keywords["else"] = TokenType::LAINNYA;
+        keywords["function"] = TokenType::FUNGSI;
+        keywords["return"] = TokenType::KEMBALIKAN;
+        keywords["import"] = TokenType::IMPOR;
+        keywords["read_file"] = TokenType::BACA_FILE;
+        keywords["write_file"] = TokenType::TULIS_FILE;
+        keywords["sama"] = TokenType::SAMA;
+        keywords["panjang"] = TokenType::PANJANG;
+        keywords["char_at"] = TokenType::CHAR_AT;
+        keywords["is_quote"] = TokenType::IS_QUOTE;
+        keywords["quote_char"] = TokenType::QUOTE_CHAR;
+        keywords["is_newline"] = TokenType::IS_NEWLINE;
+        keywords["newline_char"] = TokenType::NEWLINE_CHAR;
+        keywords["kode_at"] = TokenType::KODE_AT;
+        keywords["is_digit_kode"] = TokenType::IS_DIGIT_KODE;
+        keywords["is_letter_kode"] = TokenType::IS_LETTER_KODE;
+        keywords["potong"] = TokenType::POTONG;
+        keywords["pisah"] = TokenType::PISAH;
+        keywords["cocok"] = TokenType::COCOK;
+        keywords["urutkan"] = TokenType::URUTKAN;
+        keywords["paralel"] = TokenType::PARALEL;
+        keywords["jalankan"] = TokenType::JALANKAN;
+        keywords["tunggu"] = TokenType::TUNGGU;
+        keywords["hasilkan"] = TokenType::HASILKAN;
+        keywords["untuk"] = TokenType::UNTUK;
+        keywords["streq"] = TokenType::SAMA;      // English alias
+        keywords["strlen"] = TokenType::PANJANG;  // English alias
+    }
+    
+    std::vector<Token> tokenize() {
+        // The serial lexer stops at a NUL byte; keep that exact behaviour
+        size_t chunks = std::min<size_t>(compilerThreads(), source.length() / parallelMinChunk);
+        if (source.length() >= parallelMinBytes && chunks > 1 && source.find('\0') == std::string::npos) {
+            return tokenizeParallel(chunks);
+        }
+        
+        std::vector<Token> tokens;
+        scan(tokens);
+        tokens.push_back(Token(TokenType::END_OF_FILE, "", line, column));
+        return tokens;
+    }
+    
+    // Append the tokens of the source (without END_OF_FILE)
+    void scan(std::vector<Token>& tokens) {
+        while (pos < source.length()) {
+            skipWhitespace();
+            
+            if (current() == '\0') break;
+            
+            int startLine = line;
+            int startCol = column;
+            
+            // Newlines (statement terminators)
+            if (current() == '\n') {
+                tokens.push_back(Token(TokenType::NEWLINE, "\\n", startLine, startCol));
+                advance();
+                continue;
+            }
+            
+            // Comments
+            if (current() == '/' && peek() == '/') {
+                skipLineComment();
+                continue;
+            }
+            
+            // String literals
+            if (current() == '"') {
+                tokens.push_back(scanString());
+                continue;
+            }
+            
+            // Pattern literals: a '/' where an operand starts cannot be division
+            if (current() == '/' && !tokens.empty() &&
+                (tokens.back().type == TokenType::LPAREN || tokens.back().type == TokenType::COMMA ||
+                 tokens.back().type == TokenType::EQUAL)) {
+                size_t end = regexEnd();
+                if (end != 0) {
+                    tokens.push_back(scanRegex(end));
+                    continue;
+                }
+            }
+            
+            // Numbers
+            if (std::isdigit(current())) {
+                tokens.push_back(scanNumber());
+                continue;
+            }
+            
+            // Identifiers and keywords
+            if (std::isalpha(current()) || current() == '_') {
+                tokens.push_back(scanIdentifier());
+                continue;
+            }
+            
+            // Operators and delimiters
+            switch (current()) {
+                case '+':
+                    tokens.push_back(Token(TokenType::PLUS, "+", startLine, startCol));
+                    advance();
+                    break;
+                case '-':
+                    tokens.push_back(Token(TokenType::MINUS, "-", startLine, startCol));
+                    advance();
+                    break;
+                case '*':
+                    tokens.push_back(Token(TokenType::STAR, "*", startLine, startCol));
+                    advance();
+                    break;
+                case '/':
+                    tokens.push_back(Token(TokenType::SLASH, "/", startLine, startCol));
+                    advance();
+                    break;
+                case '=':
+                    advance();
+                    if (current() == '=') {
+                        tokens.push_back(Token(TokenType::EQUAL_EQUAL, "==", startLine, startCol));
+                        advance();
+                    } else {
+                        tokens.push_back(Token(TokenType::EQUAL, "=", startLine, startCol));
+                    }
+                    break;
+                case '<':
+                    advance();
+                    if (current() == '=') {
+                        tokens.push_back(Token(TokenType::LESS_EQUAL, "<=", startLine, startCol));
+                        advance();
+                    } else {
+                        tokens.push_back(Token(TokenType::LESS, "<", startLine, startCol));
+                    }
+                    break;
+                case '>':
+                    advance();
+                    if (current() == '=') {
+                        tokens.push_back(Token(TokenType::GREATER_EQUAL, ">=", startLine, startCol));
+                        advance();
+                    } else {
+                        tokens.push_back(Token(TokenType::GREATER, ">", startLine, startCol));
+                    }
+                    break;
+                case '!':
+                    advance();
+                    if (current() == '=') {
+                        tokens.push_back(Token(TokenType::NOT_EQUAL, "!=", startLine, startCol));
+                        advance();
+                    } else {
+                        tokens.push_back(Token(TokenType::UNKNOWN, "!", startLine, startCol));
+                    }
+                    break;
+                case '(':
+                    tokens.push_back(Token(TokenType::LPAREN, "(", startLine, startCol));
+                    advance();
+                    break;
+                case ')':
+                    tokens.push_back(Token(TokenType::RPAREN, ")", startLine, startCol));
+                    advance();
+                    break;
+                case '{':
+                    tokens.push_back(Token(TokenType::LBRACE, "{", startLine, startCol));
+                    advance();
+                    break;
+                case '}':
+                    tokens.push_back(Token(TokenType::RBRACE, "}", startLine, startCol));
+                    advance();
+                    break;
+                case '[':
+                    tokens.push_back(Token(TokenType::LBRACKET, "[", startLine, startCol));
+                    advance();
+                    break;
+                case ']':
+                    tokens.push_back(Token(TokenType::RBRACKET, "]", startLine, startCol));
+                    advance();
+                    break;
+                case ';':
+                    tokens.push_back(Token(TokenType::SEMICOLON, ";", startLine, startCol));
+                    advance();
+                    break;
+                case ':':
+                    tokens.push_back(Token(TokenType::COLON, ":", startLine, startCol));
+                    advance();
+                    break;
+                case '@': {
+                    advance();
+                    Token name = scanIdentifier();
+                    tokens.push_back(Token(TokenType::ANNOTATION, name.value, startLine, startCol));
+                    break;
+                }
+                case ',':
+                    tokens.push_back(Token(TokenType::COMMA, ",", startLine, startCol));
+                    advance();
+                    break;
+                default:
+                    tokens.push_back(Token(TokenType::UNKNOWN, std::string(1, current()), startLine, startCol));
+                    advance();
+                    break;
+            }
+        }
+    }
+};
+
+// ============================================================
+// Expression Type (for type inference)
+// ============================================================
+
+enum class ExprType {
+    INT,
+    STRING,
+    VIEW,           // Slice of a string (potong/pisah), shares the parent buffer
+    INT_ARRAY,
+    STRING_ARRAY,
+    VIEW_ARRAY,
+    INT_TASK,       // Handle from 'jalankan', awaited with 'tunggu'
+    STRING_TASK,
+    INT_CHANNEL,    // From 'saluran(int, n)'
+    STRING_CHANNEL,
+    ATOMIC_INT,     // From 'atomik(x)'
+    UNKNOWN
+};
+
+bool isArrayType(ExprType type) {
+    return type == ExprType::INT_ARRAY || type == ExprType::STRING_ARRAY || type == ExprType::VIEW_ARRAY;
+}
+
+ExprType elementType(ExprType array) {
+    if (array == ExprType::STRING_ARRAY) return ExprType::STRING;
+    if (array == ExprType::VIEW_ARRAY) return ExprType::VIEW;
+    return ExprType::INT;
+}
+
+ExprType arrayOf(ExprType element) {
+    if (element == ExprType::STRING) return ExprType::STRING_ARRAY;
+    if (element == ExprType::VIEW) return ExprType::VIEW_ARRAY;
+    return ExprType::INT_ARRAY;
+}
+
+bool isTaskType(ExprType type) {
+    return type == ExprType::INT_TASK || type == ExprType::STRING_TASK;
+}
+
+bool isChannelType(ExprType type) {
+    return type == ExprType::INT_CHANNEL || type == ExprType::STRING_CHANNEL;
+}
+
+// Expression result with type info
+struct ExprResult {
+    std::string code;
+    ExprType type;
+    
+    ExprResult(const std::string& c, ExprType t) : code(c), type(t) {}
+    ExprResult() : code(""), type(ExprType::UNKNOWN) {}
+};
+
+// C type used for a WeaR type (unannotated values default to int)
+std::string cTypeName(ExprType type) {
+    if (type == ExprType::STRING) return "char*";
+    if (type == ExprType::VIEW) return "__wear_view";
+    if (isArrayType(type)) return "__wear_array*";
+    if (isTaskType(type)) return "__wear_task*";
+    if (isChannelType(type)) return "__wear_chan*";
+    if (type == ExprType::ATOMIC_INT) return "__wear_atomic*";
+    return "int";
+}
+
+// ============================================================
+// Function Signature (collected before code generation)
+// ============================================================
+
+struct FunctionInfo {
+    std::string name;
+    std::vector<std::string> params;
+    std::vector<ExprType> paramTypes;           // UNKNOWN when not annotated
+    std::vector<ExprType> paramHints;           // Type suggested by usage in the body
+    ExprType returnType = ExprType::UNKNOWN;    // UNKNOWN when not annotated
+    std::map<std::string, std::string> annotations; // @name(arg) -> arg
+    size_t bodyStart = 0;                       // Token index of '{'
+    size_t end = 0;                             // Token index just past the closing '}'
+    bool generator = false;                     // The body uses 'hasilkan'
+};
+
+// One C definition of a function for a concrete parameter type combination
+struct Specialization {
+    std::vector<ExprType> paramTypes;
+    ExprType returnType = ExprType::UNKNOWN;    // Known from the previous inference pass
+    ExprType observedReturn = ExprType::UNKNOWN; // Joined from 'kembalikan' in this pass
+    std::string cName;
+    std::string code;                           // Generated definition
+    std::string header;                         // Generator struct definition
+    std::vector<std::string> iterates;          // Generators whose structs the struct holds
+};
+
+// Compact key for a parameter type combination, e.g. "is" for (int, teks);
+// views are 'v', arrays the upper-case letter of their element
+std::string typeKey(const std::vector<ExprType>& types) {
+    std::string key;
+    for (ExprType t : types) {
+        switch (t) {
+            case ExprType::STRING: key += 's'; break;
+            case ExprType::VIEW: key += 'v'; break;
+            case ExprType::INT_ARRAY: key += 'I'; break;
+            case ExprType::STRING_ARRAY: key += 'S'; break;
+            case ExprType::VIEW_ARRAY: key += 'V'; break;
+            case ExprType::INT_TASK: key += 't'; break;
+            case ExprType::STRING_TASK: key += 'T'; break;
+            case ExprType::INT_CHANNEL: key += 'c'; break;
+            case ExprType::STRING_CHANNEL: key += 'C'; break;
+            case ExprType::ATOMIC_INT: key += 'a'; break;
+            default: key += 'i'; break;
+        }
+    }
+    return key;
+}
+
+// ============================================================
+// Regular Expressions (cocok)
+// ============================================================
+//
+// /pattern/ literals are compiled while transpiling: pattern -> NFA
+// (Thompson construction) -> DFA (subset construction) -> minimal DFA
+// (Moore partition refinement). The program only gets the tables.
+//
+// Supported: literals, '.', [a-z] / [^...] classes, \d \w \s (and \D \W
+// \S), grouping, '|', '*', '+', '?', {m}, {m,} and {m,n}. '^' and '$'
+// anchor the whole pattern; without them any substring may match.
+
+struct RegexDfa {
+    std::vector<std::array<int, 256>> next;
+    std::vector<bool> accept;
+    int start = 0;
+    bool anchoredEnd = false;   // '$': the match must end with the text
+    
+    // Same result as the generated matcher
+    bool matches(const std::string& text) const {
+        int state = start;
+        for (unsigned char c : text) {
+            if (!anchoredEnd && accept[state]) return true;
+            state = next[state][c];
+        }
+        return accept[state];
+    }
+};
+
+class RegexCompiler {
+private:
+    struct NfaState {
+        std::bitset<256> bytes;     // Bytes leading to 'target'
+        int target = -1;
+        std::vector<int> epsilon;
+    };
+    
+    // Part of the NFA with one entry and one exit state
+    struct Fragment {
+        int start;
+        int end;
+    };
+    
+    struct Invalid {
+        std::string message;
+    };
+    
+    static const int maxStates = 10000;
+    static const int maxRepeat = 1000;
+    
+    const std::string& pattern;
+    size_t pos = 0;
+    std::vector<NfaState> nfa;
+    std::string error;
+    
+    int addState() {
+        if ((int)nfa.size() >= maxStates) fail("pattern is too large");
+        nfa.emplace_back();
+        return (int)nfa.size() - 1;
+    }
+    
+    [[noreturn]] void fail(const std::string& message) {
+        throw Invalid{message};
+    }
+    
+    bool atEnd() const { return pos >= pattern.size(); }
+    char peekChar() const { return atEnd() ? '\0' : pattern[pos]; }
+    
+    Fragment bytesFragment(const std::bitset<256>& bytes) {
+        int start = addState();
+        int end = addState();
+        nfa[start].bytes = bytes;
+        nfa[start].target = end;
+        return {start, end};
+    }
+    
+    Fragment emptyFragment() {
+        int state = addState();
+        return {state, state};
+    }
+    
+    Fragment concatenate(Fragment a, Fragment b) {
+        nfa[a.end].epsilon.push_back(b.start);
+        return {a.start, b.end};
+    }
+    
+    Fragment alternate(Fragment a, Fragment b) {
+        int start = addState();
+        int end = addState();
+        nfa[start].epsilon = {a.start, b.start};
+        nfa[a.end].epsilon.push_back(end);
+        nfa[b.end].epsilon.push_back(end);
+        return {start, end};
+    }
+    
+    // '*' (repeat) / '?' (optional) / '+' (both false: one or more)
+    Fragment repeat(Fragment a, bool optional, bool loop) {
+        int start = addState();
+        int end = addState();
+        nfa[start].epsilon.push_back(a.start);
+        if (optional) nfa[start].epsilon.push_back(end);
+        if (loop) nfa[a.end].epsilon.push_back(a.start);
+        nfa[a.end].epsilon.push_back(end);
+        return {start, end};
+    }
+    
+    // \d, \w, \s and friends; other escaped characters stand for themselves
+    std::bitset<256> escapeSet(char c) {
+        std::bitset<256> set;
+        switch (c) {
+            case 'd': case 'D':
+                for (int b = '0'; b <= '9'; b++) set.set(b);
+                break;
+            case 'w': case 'W':
+                for (int b = 0; b < 256; b++) set[b] = std::isalnum(b) || b == '_';
+                break;
+            case 's': case 'S':
+                for (char b : std::string(" \t\n\r\f\v")) set.set((unsigned char)b);
+                break;
+            case 'n': set.set('\n'); break;
+            case 't': set.set('\t'); break;
+            case 'r': set.set('\r'); break;
+            case '\0': fail("pattern ends with '\\'");
+            default:
+                if (std::isalnum((unsigned char)c)) fail(std::string("unknown escape '\\") + c + "'");
+                set.set((unsigned char)c);
+        }
+        if (c == 'D' || c == 'W' || c == 'S') set.flip();
+        return set;
+    }
+    
+    // [abc], [a-z0-9], [^"] (after '[')
+    std::bitset<256> parseClass() {
+        std::bitset<256> set;
+        bool negate = peekChar() == '^';
+        if (negate) pos++;
+        bool first = true;
+        while (!atEnd() && (peekChar() != ']' || first)) {
+            first = false;
+            char c = pattern[pos++];
+            std::bitset<256> item;
+            if (c == '\\') {
+                item = escapeSet(peekChar());
+                pos++;
+                if (item.count() != 1) {
+                    set |= item;
+                    continue;
+                }
+            } else {
+                item.set((unsigned char)c);
+            }
+            if (peekChar() == '-' && pos + 1 < pattern.size() && pattern[pos + 1] != ']' && item.count() == 1) {
+                pos++;
+                int low = 0;
+                while (!item[low]) low++;
+                char high = pattern[pos++];
+                if (high == '\\') {
+                    std::bitset<256> escaped = escapeSet(peekChar());
+                    pos++;
+                    if (escaped.count() != 1) fail("invalid range in character class");
+                    high = 0;
+                    while (!escaped[(unsigned char)high]) high++;
+                }
+                if ((unsigned char)high < low) fail("invalid range in character class");
+                for (int b = low; b <= (unsigned char)high; b++) set.set(b);
+            } else {
+                set |= item;
+            }
+        }
+        if (atEnd()) fail("missing ']'");
+        pos++;
+        if (negate) set.flip();
+        return set;
+    }
+    
+    Fragment parseAtom() {
+        char c = pattern[pos++];
+        switch (c) {
+            case '(': {
+                Fragment inner = parseAlternation();
+                if (peekChar() != ')') fail("missing ')'");
+                pos++;
+                return inner;
+            }
+            case '[':
+                return bytesFragment(parseClass());
+            case '.': {
+                std::bitset<256> any;
+                any.set();
+                any.reset('\n');
+                return bytesFragment(any);
+            }
+            case '\\': {
+                std::bitset<256> set = escapeSet(peekChar());
+                pos++;
+                return bytesFragment(set);
+            }
+            case '*': case '+': case '?': case '{':
+                fail(std::string("nothing to repeat before '") + c + "'");
+            case '^': case '$':
+                fail(std::string("'") + c + "' is only supported at the ends of the pattern");
+            default: {
+                std::bitset<256> set;
+                set.set((unsigned char)c);
+                return bytesFragment(set);
+            }
+        }
+    }
+    
+    int parseCount() {
+        if (!std::isdigit((unsigned char)peekChar())) fail("expected a number in '{}'");
+        int value = 0;
+        while (std::isdigit((unsigned char)peekChar())) {
+            value = value * 10 + (pattern[pos++] - '0');
+            if (value > maxRepeat) fail("repeat count is too large");
+        }
+        return value;
+    }
+    
+    // An atom with its quantifiers; {m,n} copies the atom by parsing it again
+    Fragment parseRepeat() {
+        size_t atomStart = pos;
+        Fragment result = parseAtom();
+        size_t atomEnd = pos;
+        bool counted = false;
+        while (!atEnd()) {
+            char c = peekChar();
+            if (c == '*' || c == '+' || c == '?') {
+                pos++;
+                result = repeat(result, c != '+', c != '?');
+            } else if (c == '{' && !counted) {
+                pos++;
+                int low = parseCount();
+                int high = low;
+                bool unbounded = false;
+                if (peekChar() == ',') {
+                    pos++;
+                    unbounded = peekChar() == '}';
+                    if (!unbounded) high = parseCount();
+                }
+                if (peekChar() != '}') fail("missing '}'");
+                pos++;
+                if (high < low) fail("invalid repeat range");
+                
+                size_t after = pos;
+                auto copy = [&]() {
+                    pos = atomStart;
+                    Fragment f = parseAtom();
+                    pos = atomEnd;
+                    return f;
+                };
+                Fragment copies = emptyFragment();
+                for (int k = 0; k < low; k++) copies = concatenate(copies, k == 0 ? result : copy());
+                if (unbounded) {
+                    copies = concatenate(copies, repeat(low == 0 ? result : copy(), true, true));
+                } else {
+                    for (int k = low; k < high; k++) {
+                        copies = concatenate(copies, repeat(k == 0 ? result : copy(), true, false));
+                    }
+                }
+                pos = after;
+                result = copies;
+                counted = true;
+            } else {
+                break;
+            }
+        }
+        return result;
+    }
+    
+    Fragment parseSequence() {
+        Fragment result = emptyFragment();
+        while (!atEnd() && peekChar() != '|' && peekChar() != ')') {
+            if (peekChar() == '$' && pos + 1 == pattern.size()) break;
+            result = concatenate(result, parseRepeat());
+        }
+        return result;
+    }
+    
+    Fragment parseAlternation() {
+        Fragment result = parseSequence();
+        while (peekChar() == '|') {
+            pos++;
+            result = alternate(result, parseSequence());
+        }
+        return result;
+    }
+    
+    void closure(std::vector<int>& states) const {
+        std::vector<bool> seen(nfa.size(), false);
+        for (int s : states) seen[s] = true;
+        for (size_t k = 0; k < states.size(); k++) {
+            for (int t : nfa[states[k]].epsilon) {
+                if (!seen[t]) {
+                    seen[t] = true;
+                    states.push_back(t);
+                }
+            }
+        }
+        std::sort(states.begin(), states.end());
+    }
+    
+    // Merge states that accept the same continuations
+    static RegexDfa minimize(const RegexDfa& dfa) {
+        size_t count = dfa.next.size();
+        std::vector<int> block(count);
+        for (size_t s = 0; s < count; s++) block[s] = dfa.accept[s] ? 1 : 0;
+        
+        size_t blocks = 0;
+        while (true) {
+            std::map<std::vector<int>, int> signatures;
+            std::vector<int> refined(count);
+            for (size_t s = 0; s < count; s++) {
+                std::vector<int> signature(257);
+                signature[0] = block[s];
+                for (int b = 0; b < 256; b++) signature[b + 1] = block[dfa.next[s][b]];
+                auto it = signatures.emplace(signature, (int)signatures.size()).first;
+                refined[s] = it->second;
+            }
+            block = refined;
+            if (signatures.size() == blocks) break;
+            blocks = signatures.size();
+        }
+        
+        RegexDfa result;
+        result.next.resize(blocks);
+        result.accept.assign(blocks, false);
+        result.anchoredEnd = dfa.anchoredEnd;
+        result.start = block[dfa.start];
+        for (size_t s = 0; s < count; s++) {
+            for (int b = 0; b < 256; b++) result.next[block[s]][b] = block[dfa.next[s][b]];
+            result.accept[block[s]] = dfa.accept[s];
+        }
+        return result;
+    }
+    
+    explicit RegexCompiler(const std::string& p) : pattern(p) {}
+    
+    RegexDfa build() {
+        bool anchoredStart = !pattern.empty() && pattern[0] == '^';
+        if (anchoredStart) pos = 1;
+        Fragment body = parseAlternation();
+        if (peekChar() == ')') fail("unmatched ')'");
+        bool anchoredEnd = peekChar() == '$';
+        
+        // Without '^' the match may start anywhere: loop on any byte first
+        int start = body.start;
+        if (!anchoredStart) {
+            start = addState();
+            nfa[start].bytes.set();
+            nfa[start].target = start;
+            nfa[start].epsilon.push_back(body.start);
+        }
+        
+        RegexDfa dfa;
+        dfa.anchoredEnd = anchoredEnd;
+        std::map<std::vector<int>, int> ids;
+        std::vector<std::vector<int>> sets;
+        std::vector<int> initial = {start};
+        closure(initial);
+        ids[initial] = 0;
+        sets.push_back(initial);
+        for (size_t d = 0; d < sets.size(); d++) {
+            std::array<int, 256> row;
+            for (int b = 0; b < 256; b++) {
+                std::vector<int> moved;
+                for (int s : sets[d]) {
+                    if (nfa[s].bytes[b] && std::find(moved.begin(), moved.end(), nfa[s].target) == moved.end()) {
+                        moved.push_back(nfa[s].target);
+                    }
+                }
+                closure(moved);
+                auto it = ids.find(moved);
+                if (it == ids.end()) {
+                    if ((int)sets.size() >= maxStates) fail("pattern is too complex");
+                    it = ids.emplace(moved, (int)sets.size()).first;
+                    sets.push_back(moved);
+                }
+                row[b] = it->second;
+            }
+            dfa.next.push_back(row);
+            dfa.accept.push_back(std::binary_search(sets[d].begin(), sets[d].end(), body.end));
+        }
+        
+        // Without '$' the first accepting state decides the match
+        if (!anchoredEnd) {
+            for (size_t s = 0; s < dfa.next.size(); s++) {
+                if (dfa.accept[s]) dfa.next[s].fill((int)s);
+            }
+        }
+        return minimize(dfa);
+    }
+
+public:
+    // Compile 'pattern' (the text between the slashes); false with a
+    // message in 'error' when it is not a supported expression
+    static bool compile(const std::string& pattern, RegexDfa& dfa, std::string& error) {
+        RegexCompiler compiler(pattern);
+        try {
+            dfa = compiler.build();
+            return true;
+        } catch (const Invalid& e) {
+            error = e.message;
+            return false;
+        }
+    }
+};
+
+// ============================================================
+// Compile-Time Evaluator
+// ============================================================
+
+// A WeaR value during compile-time evaluation
+struct ConstValue {
+    bool isString = false;
+    int number = 0;
+    std::string text;   // Raw bytes (escapes decoded)
+};
+
+// Decode the escapes the lexer leaves in a string literal; false when the
+// literal uses one the evaluator does not model
+bool decodeStringLiteral(const std::string& literal, std::string& out) {
+    out.clear();
+    for (size_t i = 0; i < literal.size(); i++) {
+        if (literal[i] != '\\') {
+            out += literal[i];
+            continue;
+        }
+        if (++i >= literal.size()) return false;
+        switch (literal[i]) {
+            case 'n': out += '\n'; break;
+            case 'r': out += '\r'; break;
+            case 't': out += '\t'; break;
+            case '\\': out += '\\'; break;
+            case '"': out += '"'; break;
+            case '\'': out += '\''; break;
+            default: {
+                // Octal escape (as written by encodeStringLiteral)
+                int value = 0;
+                int digits = 0;
+                for (; digits < 3 && i < literal.size() && literal[i] >= '0' && literal[i] <= '7'; digits++, i++) {
+                    value = value * 8 + (literal[i] - '0');
+                }
+                if (digits == 0 || value == 0 || value > 255) return false;
+                out += (char)value;
+                i--;
+            }
+        }
+    }
+    return true;
+}
+
+// C string literal body for raw bytes (inverse of decodeStringLiteral)
+std::string encodeStringLiteral(const std::string& text) {
+    std::string out;
+    for (unsigned char c : text) {
+        if (c == '\\') out += "\\\\";
+        else if (c == '"') out += "\\\"";
+        else if (c == '\n') out += "\\n";
+        else if (c == '\r') out += "\\r";
+        else if (c == '\t') out += "\\t";
+        else if (c < 0x20 || c >= 0x7f) {
+            out += '\\';
+            out += (char)('0' + (c >> 6));
+            out += (char)('0' + ((c >> 3) & 7));
+            out += (char)('0' + (c & 7));
+        } else {
+            out += (char)c;
+        }
+    }
+    return out;
+}
+
+// Runs pure WeaR functions on constant arguments at transpile time, the way
+// constexpr works in C++. It follows the semantics of the generated C; any
+// construct it cannot reproduce exactly, or running past the limits, makes
+// it give up and the call stays a runtime call.
+class ConstEvaluator {
+public:
+    static const long stepLimit = 1000000;        // Statements and operands per evaluation
+    static const size_t memoryLimit = 1 << 20;    // Bytes of strings built per evaluation
+    static const int depthLimit = 200;            // Nested WeaR calls
+    
+    ConstEvaluator(const std::vector<Token>& toks,
+                   const std::unordered_map<std::string, FunctionInfo>& fns,
+                   const std::set<std::string>& pure)
+        : tokens(toks), functions(fns), pureFunctions(pure) {}
+    
+    // Run the 'var' statements starting at each of 'declarations', then the
+    // expression at tokens[expression], with only 'bindings' in scope
+    bool evaluateWith(const std::unordered_map<std::string, ConstValue>& bindings,
+                      const std::vector<size_t>& declarations, size_t expression, ConstValue& result) {
+        steps = 0;
+        memory = 0;
+        depth = 0;
+        returning = false;
+        scopes.assign(1, bindings);
+        try {
+            for (size_t declaration : declarations) {
+                pos = declaration;
+                if (!check(TokenType::VAR)) return false;
+                executeStatement();
+            }
+            pos = expression;
+            result = evaluateExpression();
+            return true;
+        } catch (const GiveUp&) {
+            return false;
+        }
+    }
+    
+    // Evaluate name(args); false when the call cannot be evaluated
+    bool evaluate(const std::string& name, const std::vector<ConstValue>& args, ConstValue& result) {
+        steps = 0;
+        memory = 0;
+        depth = 0;
+        returning = false;
+        scopes.clear();
+        try {
+            result = call(name, args);
+            return true;
+        } catch (const GiveUp&) {
+            return false;
+        }
+    }
+    
+private:
+    struct GiveUp {};
+    using Scope = std::unordered_map<std::string, ConstValue>;
+    
+    // Operator or operand of a flat expression, as the code generator sees it
+    struct Part {
+        TokenType op = TokenType::UNKNOWN;   // UNKNOWN for an operand
+        size_t begin = 0;                    // Operand token range
+        size_t end = 0;
+    };
+    
+    const std::vector<Token>& tokens;
+    const std::unordered_map<std::string, FunctionInfo>& functions;
+    const std::set<std::string>& pureFunctions;
+    size_t pos = 0;
+    std::vector<Scope> scopes;   // Blocks of the running call, innermost last
+    long steps = 0;
+    size_t memory = 0;
+    int depth = 0;
+    bool returning = false;
+    ConstValue returnValue;
+    std::map<std::string, RegexDfa> patterns;   // Compiled cocok patterns
+    
+    [[noreturn]] static void giveUp() { throw GiveUp(); }
+    
+    void step() {
+        if (++steps > stepLimit) giveUp();
+    }
+    
+    bool check(TokenType type) const {
+        return pos < tokens.size() && tokens[pos].type == type;
+    }
+    
+    void expect(TokenType type) {
+        if (!check(type)) giveUp();
+        pos++;
+    }
+    
+    ConstValue makeInt(long long value) {
+        if (value < INT_MIN || value > INT_MAX) giveUp();   // Overflow is undefined in C
+        ConstValue v;
+        v.number = (int)value;
+        return v;
+    }
+    
+    // 'charged' is the number of new bytes (a concat only adds its right side)
+    ConstValue makeString(const std::string& text, size_t charged) {
+        memory += charged;
+        if (memory > memoryLimit) giveUp();
+        ConstValue v;
+        v.isString = true;
+        v.text = text;
+        return v;
+    }
+    
+    static int asInt(const ConstValue& v) {
+        if (v.isString) giveUp();
+        return v.number;
+    }
+    
+    static const std::string& asString(const ConstValue& v) {
+        if (!v.isString) giveUp();
+        return v.text;
+    }
+    
+    ConstValue* lookup(const std::string& name) {
+        for (size_t i = scopes.size(); i-- > 0;) {
+            auto it = scopes[i].find(name);
+            if (it != scopes[i].end()) return &it->second;
+        }
+        return nullptr;
+    }
+    
+    ConstValue call(const std::string& name, const std::vector<ConstValue>& args) {
+        auto fn = functions.find(name);
+        if (fn == functions.end() || !pureFunctions.count(name) || ++depth > depthLimit) giveUp();
+        const FunctionInfo& info = fn->second;
+        if (args.size() != info.params.size()) giveUp();
+        
+        // Only the parameters are visible in the body
+        Scope params;
+        for (size_t i = 0; i < args.size(); i++) {
+            ExprType declared = info.paramTypes[i];
+            if (declared != ExprType::UNKNOWN && (declared == ExprType::STRING) != args[i].isString) giveUp();
+            params[info.params[i]] = args[i];
+        }
+        std::vector<Scope> callerScopes;
+        callerScopes.swap(scopes);
+        scopes.push_back(params);
+        size_t callerPos = pos;
+        pos = info.bodyStart;
+        
+        executeBlock();
+        if (!returning) giveUp();   // Falling off the end has no value in C either
+        returning = false;
+        ConstValue result = returnValue;
+        if (info.returnType != ExprType::UNKNOWN && (info.returnType == ExprType::STRING) != result.isString) {
+            giveUp();
+        }
+        
+        pos = callerPos;
+        scopes.swap(callerScopes);
+        depth--;
+        return result;
+    }
+    
+    // ---- Statements ----
+    
+    void executeBlock() {
+        expect(TokenType::LBRACE);
+        scopes.emplace_back();
+        while (!returning) {
+            while (check(TokenType::NEWLINE)) pos++;
+            if (check(TokenType::RBRACE)) break;
+            executeStatement();
+        }
+        scopes.pop_back();
+        if (!returning) expect(TokenType::RBRACE);
+    }
+    
+    void skipGroup(TokenType open, TokenType close) {
+        expect(open);
+        for (int nesting = 1; nesting > 0; pos++) {
+            if (pos >= tokens.size()) giveUp();
+            if (tokens[pos].type == open) nesting++;
+            if (tokens[pos].type == close) nesting--;
+        }
+    }
+    
+    bool evaluateCondition() {
+        expect(TokenType::LPAREN);
+        bool taken = asInt(evaluateExpression()) != 0;
+        expect(TokenType::RPAREN);
+        return taken;
+    }
+    
+    void executeStatement() {
+        step();
+        switch (tokens[pos].type) {
+            case TokenType::VAR: {
+                pos++;
+                if (!check(TokenType::IDENTIFIER)) giveUp();
+                std::string name = tokens[pos++].value;
+                expect(TokenType::EQUAL);
+                ConstValue value = evaluateExpression();
+                scopes.back()[name] = value;
+                break;
+            }
+            case TokenType::IDENTIFIER: {
+                if (pos + 1 < tokens.size() && tokens[pos + 1].type == TokenType::EQUAL) {
+                    std::string name = tokens[pos].value;
+                    pos += 2;
+                    ConstValue value = evaluateExpression();
+                    ConstValue* slot = lookup(name);
+                    // C variables keep the type they were declared with
+                    if (slot == nullptr || slot->isString != value.isString) giveUp();
+                    *slot = value;
+                } else {
+                    evaluateExpression();   // Call statement
+                }
+                break;
+            }
+            case TokenType::SELAMA: {
+                pos++;
+                size_t condition = pos;
+                while (true) {
+                    step();
+                    pos = condition;
+                    if (!evaluateCondition()) {
+                        skipGroup(TokenType::LBRACE, TokenType::RBRACE);
+                        break;
+                    }
+                    executeBlock();
+                    if (returning) return;
+                }
+                break;
+            }
+            case TokenType::JIKA:
+                executeIf();
+                break;
+            case TokenType::KEMBALIKAN:
+                pos++;
+                returnValue = evaluateExpression();
+                returning = true;
+                return;
+            default:
+                giveUp();   // I/O and anything else the evaluator does not model
+        }
+        if (!returning && !check(TokenType::NEWLINE) && !check(TokenType::RBRACE)) giveUp();
+    }
+    
+    void executeIf() {
+        pos++; // skip 'jika'
+        bool taken = evaluateCondition();
+        if (taken) {
+            executeBlock();
+            if (returning) return;
+        } else {
+            skipGroup(TokenType::LBRACE, TokenType::RBRACE);
+        }
+        
+        if (!check(TokenType::LAINNYA)) return;
+        pos++;
+        if (!taken) {
+            if (check(TokenType::JIKA)) executeIf();
+            else executeBlock();
+            return;
+        }
+        // Skip the rest of the chain
+        while (check(TokenType::JIKA)) {
+            pos++;
+            skipGroup(TokenType::LPAREN, TokenType::RPAREN);
+            skipGroup(TokenType::LBRACE, TokenType::RBRACE);
+            if (!check(TokenType::LAINNYA)) return;
+            pos++;
+        }
+        skipGroup(TokenType::LBRACE, TokenType::RBRACE);
+    }
+    
+    // ---- Expressions ----
+    
+    static bool isOperator(TokenType type) {
+        switch (type) {
+            case TokenType::PLUS: case TokenType::MINUS: case TokenType::STAR: case TokenType::SLASH:
+            case TokenType::LESS: case TokenType::GREATER: case TokenType::LESS_EQUAL:
+            case TokenType::GREATER_EQUAL: case TokenType::EQUAL_EQUAL: case TokenType::NOT_EQUAL:
+            case TokenType::QUESTION: case TokenType::COLON:
+                return true;
+            default:
+                return false;
+        }
+    }
+    
+    static bool startsOperand(TokenType type) {
+        switch (type) {
+            case TokenType::INTEGER: case TokenType::STRING: case TokenType::IDENTIFIER:
+            case TokenType::LPAREN: case TokenType::BACA_FILE: case TokenType::SAMA:
+            case TokenType::PANJANG: case TokenType::CHAR_AT: case TokenType::IS_QUOTE:
+            case TokenType::QUOTE_CHAR: case TokenType::IS_NEWLINE: case TokenType::NEWLINE_CHAR:
+            case TokenType::KODE_AT: case TokenType::IS_DIGIT_KODE: case TokenType::IS_LETTER_KODE:
+            case TokenType::POTONG: case TokenType::COCOK:
+                return true;
+            default:
+                return false;
+        }
+    }
+    
+    // Collect the parts first so '?:' only evaluates the branch it takes
+    ConstValue evaluateExpression() {
+        std::vector<Part> parts;
+        while (pos < tokens.size()) {
+            TokenType type = tokens[pos].type;
+            Part part;
+            if (isOperator(type)) {
+                part.op = type;
+                pos++;
+            } else if (startsOperand(type)) {
+                part.begin = pos;
+                if (type == TokenType::LPAREN) {
+                    skipGroup(TokenType::LPAREN, TokenType::RPAREN);
+                } else if (++pos < tokens.size() && tokens[pos].type == TokenType::LPAREN) {
+                    skipGroup(TokenType::LPAREN, TokenType::RPAREN);
+                }
+                part.end = pos;
+            } else {
+                break;
+            }
+            parts.push_back(part);
+        }
+        
+        size_t after = pos;
+        ConstValue result = evaluateParts(parts, 0, parts.size());
+        pos = after;
+        return result;
+    }
+    
+    ConstValue evaluateParts(const std::vector<Part>& parts, size_t from, size_t to) {
+        step();
+        if (from >= to) giveUp();
+        
+        // '?:' binds loosest in C (mixed with '+' the generated C is not
+        // a plain conditional, so leave those alone)
+        for (size_t i = from; i < to; i++) {
+            if (parts[i].op != TokenType::QUESTION) continue;
+            size_t colon = i + 1;
+            for (int nesting = 0; colon < to; colon++) {
+                if (parts[colon].op == TokenType::PLUS) giveUp();
+                if (parts[colon].op == TokenType::QUESTION) nesting++;
+                if (parts[colon].op == TokenType::COLON && nesting-- == 0) break;
+            }
+            for (size_t k = from; k < to; k++) {
+                if (parts[k].op == TokenType::PLUS) giveUp();
+            }
+            if (colon >= to) giveUp();
+            return asInt(evaluateParts(parts, from, i)) != 0 ? evaluateParts(parts, i + 1, colon)
+                                                             : evaluateParts(parts, colon + 1, to);
+        }
+        
+        std::vector<ConstValue> values(to - from);
+        bool hasString = false;
+        bool hasPlus = false;
+        for (size_t i = from; i < to; i++) {
+            if (parts[i].op == TokenType::UNKNOWN) {
+                values[i - from] = evaluateOperand(parts[i]);
+                if (values[i - from].isString) hasString = true;
+            } else if (parts[i].op == TokenType::PLUS) {
+                hasPlus = true;
+            }
+        }
+        
+        if (hasString && hasPlus && to - from >= 3) {
+            return concatenate(parts, values, from, to);
+        }
+        if (to - from == 1) return values[0];
+        return makeInt(arithmetic(parts, values, from, to));
+    }
+    
+    // Mirrors buildStringConcat: operands are whatever lies between two '+'
+    ConstValue concatenate(const std::vector<Part>& parts, const std::vector<ConstValue>& values,
+                           size_t from, size_t to) {
+        std::vector<ConstValue> operands;
+        size_t start = from;
+        for (size_t i = from; i <= to; i++) {
+            if (i < to && parts[i].op != TokenType::PLUS) continue;
+            if (i - start == 1) {
+                operands.push_back(values[start - from]);
+            } else if (i > start) {
+                std::vector<Part> group(parts.begin() + start, parts.begin() + i);
+                std::vector<ConstValue> groupValues(values.begin() + (start - from), values.begin() + (i - from));
+                for (const auto& v : groupValues) {
+                    if (v.isString) giveUp();   // e.g. a string comparison inside a concat
+                }
+                operands.push_back(makeInt(arithmetic(group, groupValues, 0, group.size())));
+            }
+            start = i + 1;
+        }
+        if (operands.empty()) return makeString("", 0);
+        
+        ConstValue result = operands[0];
+        for (size_t i = 1; i < operands.size(); i++) {
+            const ConstValue& next = operands[i];
+            if (!result.isString && !next.isString) {
+                result = makeInt((long long)result.number + next.number);
+                continue;
+            }
+            std::string left = result.isString ? result.text : std::to_string(result.number);
+            std::string right = next.isString ? next.text : std::to_string(next.number);
+            result = makeString(left + right, right.size());
+        }
+        return result;
+    }
+    
+    // Integer expression with C precedence over evaluated operands
+    long long arithmetic(const std::vector<Part>& parts, const std::vector<ConstValue>& values,
+                         size_t from, size_t to) {
+        size_t i = from;
+        long long result = climb(parts, values, from, to, i, 0);
+        if (i != to) giveUp();
+        return result;
+    }
+    
+    static int precedence(TokenType op) {
+        switch (op) {
+            case TokenType::STAR: case TokenType::SLASH: return 4;
+            case TokenType::PLUS: case TokenType::MINUS: return 3;
+            case TokenType::LESS: case TokenType::GREATER:
+            case TokenType::LESS_EQUAL: case TokenType::GREATER_EQUAL: return 2;
+            case TokenType::EQUAL_EQUAL: case TokenType::NOT_EQUAL: return 1;
+            default: return -1;
+        }
+    }
+    
+    long long unary(const std::vector<Part>& parts, const std::vector<ConstValue>& values,
+                    size_t from, size_t to, size_t& i) {
+        if (i >= to) giveUp();
+        if (parts[i].op == TokenType::MINUS) {
+            i++;
+            return -unary(parts, values, from, to, i);
+        }
+        if (parts[i].op != TokenType::UNKNOWN) giveUp();
+        return asInt(values[i++ - from]);
+    }
+    
+    long long climb(const std::vector<Part>& parts, const std::vector<ConstValue>& values,
+                    size_t from, size_t to, size_t& i, int minPrecedence) {
+        long long left = unary(parts, values, from, to, i);
+        while (i < to) {
+            int prec = precedence(parts[i].op);
+            if (prec < 0) giveUp();
+            if (prec < minPrecedence) break;
+            TokenType op = parts[i++].op;
+            long long right = climb(parts, values, from, to, i, prec + 1);
+            switch (op) {
+                case TokenType::STAR: left = makeInt(left * right).number; break;
+                case TokenType::SLASH:
+                    if (right == 0) giveUp();
+                    left = makeInt(left / right).number;
+                    break;
+                case TokenType::PLUS: left = makeInt(left + right).number; break;
+                case TokenType::MINUS: left = makeInt(left - right).number; break;
+                case TokenType::LESS: left = left < right; break;
+                case TokenType::GREATER: left = left > right; break;
+                case TokenType::LESS_EQUAL: left = left <= right; break;
+                case TokenType::GREATER_EQUAL: left = left >= right; break;
+                case TokenType::EQUAL_EQUAL: left = left == right; break;
+                default: left = left != right; break;
+            }
+        }
+        return left;
+    }
+    
+    std::vector<ConstValue> evaluateArguments() {
+        expect(TokenType::LPAREN);
+        std::vector<ConstValue> args;
+        while (!check(TokenType::RPAREN)) {
+            if (!args.empty()) expect(TokenType::COMMA);
+            args.push_back(evaluateExpression());
+        }
+        expect(TokenType::RPAREN);
+        return args;
+    }
+    
+    ConstValue evaluateOperand(const Part& part) {
+        step();
+        pos = part.begin;
+        const Token& tok = tokens[pos];
+        ConstValue value;
+        if (tok.type == TokenType::INTEGER) {
+            value = makeInt(std::strtoll(tok.value.c_str(), nullptr, 10));
+            pos++;
+        } else if (tok.type == TokenType::STRING) {
+            std::string text;
+            if (!decodeStringLiteral(tok.value, text)) giveUp();
+            value = makeString(text, text.size());
+            pos++;
+        } else if (tok.type == TokenType::LPAREN) {
+            pos++;
+            value = evaluateExpression();
+            expect(TokenType::RPAREN);
+        } else if (tok.type == TokenType::COCOK) {
+            pos++;
+            expect(TokenType::LPAREN);
+            ConstValue subject = evaluateExpression();
+            expect(TokenType::COMMA);
+            if (!check(TokenType::REGEX)) giveUp();
+            auto compiled = patterns.find(tokens[pos].value);
+            if (compiled == patterns.end()) {
+                RegexDfa dfa;
+                std::string error;
+                if (!RegexCompiler::compile(tokens[pos].value, dfa, error)) giveUp();
+                compiled = patterns.emplace(tokens[pos].value, dfa).first;
+            }
+            pos++;
+            expect(TokenType::RPAREN);
+            value = makeInt(compiled->second.matches(asString(subject)));
+        } else if (tok.type == TokenType::IDENTIFIER) {
+            pos++;
+            if (check(TokenType::LPAREN)) {
+                std::vector<ConstValue> args = evaluateArguments();
+                value = call(tok.value, args);
+            } else {
+                ConstValue* slot = lookup(tok.value);
+                if (slot == nullptr) giveUp();
+                value = *slot;
+            }
+        } else {
+            pos++;
+            value = builtin(tok.type, evaluateArguments());
+        }
+        if (pos != part.end) giveUp();
+        return value;
+    }
+    
+    // The pure runtime builtins, byte for byte
+    ConstValue builtin(TokenType type, const std::vector<ConstValue>& args) {
+        auto need = [&](size_t count) {
+            if (args.size() != count) giveUp();
+        };
+        switch (type) {
+            case TokenType::SAMA:
+                need(2);
+                return makeInt(asString(args[0]) == asString(args[1]));
+            case TokenType::PANJANG:
+                need(1);
+                return makeInt((long long)asString(args[0]).size());
+            case TokenType::CHAR_AT: {
+                need(2);
+                const std::string& s = asString(args[0]);
+                int index = asInt(args[1]);
+                return makeString(index >= 0 && index < (int)s.size() ? std::string(1, s[index]) : "", 1);
+            }
+            case TokenType::KODE_AT: {
+                need(2);
+                const std::string& s = asString(args[0]);
+                int index = asInt(args[1]);
+                return makeInt(index >= 0 && index < (int)s.size() ? (unsigned char)s[index] : 0);
+            }
+            case TokenType::IS_QUOTE:
+                need(1);
+                return makeInt(!asString(args[0]).empty() && asString(args[0])[0] == '"');
+            case TokenType::QUOTE_CHAR:
+                need(0);
+                return makeString("\"", 1);
+            case TokenType::IS_NEWLINE: {
+                need(1);
+                const std::string& s = asString(args[0]);
+                return makeInt(!s.empty() && (s[0] == '\n' || s[0] == '\r'));
+            }
+            case TokenType::NEWLINE_CHAR:
+                need(0);
+                return makeString("\n", 1);
+            case TokenType::IS_DIGIT_KODE: {
+                need(1);
+                int code = asInt(args[0]) & 0xFF;
+                return makeInt(code >= '0' && code <= '9');
+            }
+            case TokenType::IS_LETTER_KODE: {
+                need(1);
+                int code = asInt(args[0]) & 0xFF;
+                return makeInt((code >= 'A' && code <= 'Z') || (code >= 'a' && code <= 'z') || code == '_');
+            }
+            case TokenType::POTONG: {
+                need(3);
+                const std::string& s = asString(args[0]);
+                int size = (int)s.size();
+                int start = asInt(args[1]);
+                int len = asInt(args[2]);
+                if (start < 0) start = 0;
+                if (start > size) start = size;
+                if (len < 0) len = 0;
+                if (len > size - start) len = size - start;
+                return makeString(s.substr(start, len), len);
+            }
+            default:
+                giveUp();   // baca_file: the file may change before the program runs
+        }
+    }
+};
+
+// ============================================================
+// Code Generator (Transpiler to C)
+// ============================================================
+
+class CodeGenerator {
+private:
+    // The tokens and program-wide tables. Workers generating clones share
+    // their parent's (see the worker constructor) and leave 'own' empty
+    struct SharedState {
+        std::vector<Token> tokens;
+        std::unordered_map<std::string, FunctionInfo> functions;
+        std::map<std::string, ExprType> knownReturns;
+        std::map<std::string, size_t> knownSpecCounts;
+        std::set<std::string> pureFunctions;
+    } own;
+    
+    std::vector<Token>& tokens;
+    size_t pos = 0;
+    std::ostringstream functionsOutput;  // Functions go here (before main)
+    std::ostringstream mainOutput;       // Main code goes here
+    std::ostringstream* currentOutput;   // Pointer to current output stream
+    int indentLevel = 1;
+    bool inFunction = false;
+    std::unordered_set<std::string> declaredFunctions;
+    std::unordered_map<std::string, ExprType> varTypes;
+    std::unordered_map<std::string, FunctionInfo>& functions;
+    std::vector<std::string> functionOrder;  // Source order of declarations
+    
+    // Whole-program type inference state
+    std::unordered_map<std::string, std::vector<Specialization>> specializations;
+    std::vector<std::pair<std::string, size_t>> specQueue;    // Clones still to generate
+    std::map<std::string, ExprType>& knownReturns;            // "name(key)" -> return type
+    std::map<std::string, size_t>& knownSpecCounts;           // Clones per function last pass
+    std::set<std::string> returnConflicts;
+    std::map<int, std::string> assignConflicts;    // Line -> message, reported after the last pass
+    ExprType currentReturn = ExprType::UNKNOWN;
+    ExprType currentKnownReturn = ExprType::UNKNOWN;   // Return type of the clone (previous pass)
+    std::string currentFunction;
+    std::vector<ExprType> currentParamTypes;
+    bool currentUsesTailLoop = false;
+    std::vector<std::string> tailCalls;   // "f (line N)" for each call turned into a loop
+    std::vector<std::string> keptTailCalls;   // The same, for calls kept because f is @ingat
+    std::set<std::string> uncachedClones;     // @ingat clones the cache cannot hold
+    bool memoStats = false;
+    std::unordered_map<std::string, std::string> builderVars;   // Accumulated string -> its builder
+    int builderCounter = 0;
+    bool usesSort = false;   // Emit WEAR_SORT_RUNTIME (and the thread pool)
+    bool usesVector = false; // Emit WEAR_VECTOR_RUNTIME
+    bool usesParalel = false;           // Emit WEAR_LOOP_RUNTIME (and the thread pool)
+    bool usesTasks = false;             // Emit WEAR_TASK_RUNTIME (and the thread pool)
+    bool usesChannels = false;          // Emit WEAR_CHANNEL_RUNTIME
+    bool usesAtomics = false;           // Emit WEAR_ATOMIC_RUNTIME
+    bool usesFiles = false;             // Emit WEAR_FILES_RUNTIME (and the thread pool)
+    std::ostringstream workersOutput;   // Outlined paralel loop bodies and jalankan tasks
+    int workerCounter = 0;
+    bool inParalel = false;
+    bool autoParalel = false;           // --auto-paralel
+    static const int autoParalelMinTrips = 1000;
+    std::map<int, std::string> autoParalelNotes;   // Line of each selama -> what became of it
+    size_t expressionEnd = SIZE_MAX;    // Expressions also stop at this token (paralel ranges)
+    bool inGenerator = false;
+    int yieldCounter = 0;               // States of the current generator
+    int iteratorCounter = 0;
+    std::vector<std::pair<std::string, ExprType>> generatorLocals;       // Kept in the struct across hasilkan
+    std::vector<std::pair<std::string, std::string>> generatorIterators; // Struct field -> generator clone
+    
+    // Clone workers (see drainSpecQueue)
+    bool isWorker = false;
+    std::vector<std::pair<std::string, std::vector<ExprType>>> requestedClones;
+    std::vector<Token> deferredPatterns;        // Pattern tables the parent creates
+    std::vector<std::string> deferredScans;     // Scan class tables the parent creates
+    static constexpr const char* generatorSaveMarker = "/* __wear_save_locals */";
+    
+    // Dead code elimination results
+    std::vector<std::string> removedFunctions;
+    std::vector<std::string> removedConstants;
+    std::set<std::string> inlinedFunctions;
+    std::set<int> usedFiles;
+    
+    Token current() const {
+        return pos < tokens.size() ? tokens[pos] : tokens.back();
+    }
+    
+    Token peek(int offset = 1) const {
+        size_t idx = pos + offset;
+        return idx < tokens.size() ? tokens[idx] : tokens.back();
+    }
+    
+    void advance() {
+        if (pos < tokens.size()) pos++;
+    }
+    
+    bool match(TokenType type) {
+        if (current().type == type) {
+            advance();
+            return true;
+        }
+        return false;
+    }
+    
+    bool check(TokenType type) const {
+        return current().type == type;
+    }
+    
+    void expect(TokenType type, const std::string& message) {
+        if (!match(type)) {
+            std::cerr << "Error at line " << current().line 
+                      << ", column " << current().column 
+                      << ": " << message << std::endl;
+            std::exit(1);
+        }
+    }
+    
+    std::string indent() const {
+        return std::string(indentLevel * 4, ' ');
+    }
+    
+    void emitLine(const std::string& code) {
+        *currentOutput << indent() << code << "\n";
+    }
+    
+    void emit(const std::string& code) {
+        *currentOutput << code;
+    }
+    
+    // Check if identifier is a string variable
+    bool isStringVar(const std::string& name) {
+        auto it = varTypes.find(name);
+        return it != varTypes.end() && it->second == ExprType::STRING;
+    }
+    
+    // Type of a variable (unknown names are taken as int)
+    ExprType varType(const std::string& name) const {
+        auto it = varTypes.find(name);
+        return it != varTypes.end() ? it->second : ExprType::INT;
+    }
+    
+    // A view is copied into a NUL-terminated string only where one is
+    // required: C APIs, 'teks' variables, parameters and returns
+    static std::string asCString(const ExprResult& e) {
+        return e.type == ExprType::VIEW ? "__wear_view_str(" + e.code + ")" : e.code;
+    }
+    
+    static std::string asView(const ExprResult& e) {
+        return e.type == ExprType::VIEW ? e.code : "__wear_view_of(" + e.code + ")";
+    }
+    
+    // Value converted for a variable, parameter or return of type 'target'
+    static std::string coerce(const ExprResult& e, ExprType target) {
+        if (target == ExprType::STRING) return asCString(e);
+        if (target == ExprType::VIEW && e.type == ExprType::STRING) return asView(e);
+        return e.code;
+    }
+    
+    // A type as error messages name it
+    static std::string describeType(ExprType type) {
+        switch (type) {
+            case ExprType::INT: return "an int";
+            case ExprType::STRING: case ExprType::VIEW: return "a string";
+            case ExprType::INT_ARRAY: return "an int array";
+            case ExprType::STRING_ARRAY: return "a teks array";
+            case ExprType::VIEW_ARRAY: return "an array of pisah pieces";
+            case ExprType::INT_TASK: case ExprType::STRING_TASK: return "a task";
+            case ExprType::INT_CHANNEL: case ExprType::STRING_CHANNEL: return "a channel";
+            case ExprType::ATOMIC_INT: return "an atomik int";
+            default: return "a value of unknown type";
+        }
+    }
+    
+    // An array as text, the way cetak and '+' show it: "[1, 2, 3]"
+    static std::string arrayText(const ExprResult& e) {
+        int kind = e.type == ExprType::INT_ARRAY ? 0 : e.type == ExprType::STRING_ARRAY ? 1 : 2;
+        return "__wear_array_str(" + e.code + ", " + std::to_string(kind) + ")";
+    }
+    
+    // Postfix 'a[i]' on an array operand
+    ExprResult generateIndexing(ExprResult operand) {
+        if (!isArrayType(operand.type) || !match(TokenType::LBRACKET)) return operand;
+        auto index = generateTypedExpression();
+        expect(TokenType::RBRACKET, "Expected ']'");
+        ExprType element = elementType(operand.type);
+        return ExprResult("(*(" + cTypeName(element) + "*)__wear_array_at(" + operand.code + ", " +
+                          index.code + "))", element);
+    }
+    
+    // '[a, b, c]': any string element makes a teks array (ints are
+    // converted), otherwise all views or all ints
+    ExprResult generateArrayLiteral() {
+        expect(TokenType::LBRACKET, "Expected '['");
+        std::vector<ExprResult> items;
+        while (match(TokenType::NEWLINE)) {
+        }
+        while (!check(TokenType::RBRACKET) && !check(TokenType::END_OF_FILE)) {
+            if (!items.empty()) {
+                expect(TokenType::COMMA, "Expected ',' between array elements");
+                while (match(TokenType::NEWLINE)) {
+                }
+            }
+            items.push_back(generateTypedExpression());
+            while (match(TokenType::NEWLINE)) {
+            }
+        }
+        expect(TokenType::RBRACKET, "Expected ']' after array elements");
+        
+        bool ints = false;
+        bool views = false;
+        bool strings = false;
+        for (const auto& item : items) {
+            if (isArrayType(item.type)) {
+                std::cerr << "Error at line " << current().line << ": Arrays of arrays are not supported" << std::endl;
+                std::exit(1);
+            }
+            if (item.type == ExprType::STRING) strings = true;
+            else if (item.type == ExprType::VIEW) views = true;
+            else ints = true;
+        }
+        ExprType element = strings || (views && ints) ? ExprType::STRING
+                         : views ? ExprType::VIEW : ExprType::INT;
+        if (items.empty()) {
+            return ExprResult("__wear_array_new(0, sizeof(int))", ExprType::INT_ARRAY);
+        }
+        
+        std::string cType = cTypeName(element);
+        std::string code = "__wear_array_from(" + std::to_string(items.size()) + ", sizeof(" + cType +
+                           "), (" + cType + "[]){";
+        for (size_t i = 0; i < items.size(); i++) {
+            if (i > 0) code += ", ";
+            bool number = items[i].type != ExprType::STRING && items[i].type != ExprType::VIEW;
+            code += element == ExprType::STRING && number ? "__wear_int_to_str(" + items[i].code + ")"
+                                                          : coerce(items[i], element);
+        }
+        code += "})";
+        return ExprResult(code, arrayOf(element));
+    }
+    
+    // jumlah, maks, min, hitung_jika, tambah_semua and kali_semua are
+    // builtins unless the program defines a function of that name
+    bool isIntArrayBuiltin(const std::string& name) const {
+        static const std::set<std::string> builtins = {
+            "jumlah", "maks", "min", "hitung_jika", "tambah_semua", "kali_semua"
+        };
+        return builtins.count(name) > 0 && functions.find(name) == functions.end();
+    }
+    
+    // An int array with the tambah_semua/kali_semua steps to apply to it.
+    // Nested maps are not run one by one: the runtime folds the steps and
+    // makes a single pass
+    struct IntArrayChain {
+        std::string array;
+        std::vector<std::string> steps;   // "0, v" adds v, "1, v" multiplies by v
+        
+        std::string args() const {
+            if (steps.empty()) return array + ", NULL, 0";
+            std::string list;
+            for (const auto& step : steps) list += (list.empty() ? "" : ", ") + step;
+            return array + ", (const int[]){" + list + "}, " + std::to_string(steps.size());
+        }
+    };
+    
+    // The int array argument of 'builtin'; a map call that is the whole
+    // argument joins the chain
+    IntArrayChain generateIntArrayChain(const std::string& builtin) {
+        Token tok = current();
+        if (tok.type == TokenType::IDENTIFIER && (tok.value == "tambah_semua" || tok.value == "kali_semua") &&
+            isIntArrayBuiltin(tok.value) && peek().type == TokenType::LPAREN) {
+            size_t close = pos + 1;
+            for (int depth = 0; close < tokens.size(); close++) {
+                if (tokens[close].type == TokenType::LPAREN) depth++;
+                if (tokens[close].type == TokenType::RPAREN && --depth == 0) break;
+            }
+            TokenType after = close + 1 < tokens.size() ? tokens[close + 1].type : TokenType::END_OF_FILE;
+            if (after == TokenType::COMMA || after == TokenType::RPAREN) {
+                advance();
+                return generateMapChain(tok.value);
+            }
+        }
+        auto array = generateTypedExpression();
+        if (array.type != ExprType::INT_ARRAY) {
+            std::cerr << "Error at line " << tok.line << ": " << builtin << " expects an int array" << std::endl;
+            std::exit(1);
+        }
+        return IntArrayChain{array.code, {}};
+    }
+    
+    // 'tambah_semua(a, x)' / 'kali_semua(a, x)' (after the name)
+    IntArrayChain generateMapChain(const std::string& name) {
+        expect(TokenType::LPAREN, "Expected '(' after '" + name + "'");
+        IntArrayChain chain = generateIntArrayChain(name);
+        expect(TokenType::COMMA, "Expected ',' between arguments");
+        auto value = generateTypedExpression();
+        expect(TokenType::RPAREN, "Expected ')'");
+        chain.steps.push_back((name == "tambah_semua" ? "0, " : "1, ") + value.code);
+        return chain;
+    }
+    
+    // Int array builtins (after the name):
+    //   jumlah(a), maks(a), min(a)       sum / largest / smallest element
+    //   hitung_jika(a, > x)              elements passing the comparison
+    //   tambah_semua(a, x), kali_semua(a, x)   new array with x added / multiplied
+    ExprResult generateIntArrayBuiltin(const std::string& name) {
+        usesVector = true;
+        if (name == "tambah_semua" || name == "kali_semua") {
+            return ExprResult("__wear_map_int(" + generateMapChain(name).args() + ")", ExprType::INT_ARRAY);
+        }
+        
+        expect(TokenType::LPAREN, "Expected '(' after '" + name + "'");
+        IntArrayChain chain = generateIntArrayChain(name);
+        std::string code;
+        if (name == "hitung_jika") {
+            static const std::map<TokenType, int> tests = {
+                {TokenType::GREATER, 0}, {TokenType::LESS, 1}, {TokenType::EQUAL_EQUAL, 2},
+                {TokenType::LESS_EQUAL, 3}, {TokenType::GREATER_EQUAL, 4}, {TokenType::NOT_EQUAL, 5}
+            };
+            expect(TokenType::COMMA, "Expected ',' between arguments");
+            auto test = tests.find(current().type);
+            if (test == tests.end()) {
+                std::cerr << "Error at line " << current().line
+                          << ": hitung_jika expects a comparison such as '> 0' after the array" << std::endl;
+                std::exit(1);
+            }
+            advance();
+            auto value = generateTypedExpression();
+            code = "__wear_hitung_jika(" + chain.args() + ", " + std::to_string(test->second) + ", " +
+                   value.code + ")";
+        } else {
+            code = "__wear_" + name + "(" + chain.args() + ")";
+        }
+        expect(TokenType::RPAREN, "Expected ')'");
+        return ExprResult(code, ExprType::INT);
+    }
+    
+    // saluran, kirim, terima, coba_kirim, coba_terima and tutup are
+    // builtins unless the program defines a function of that name
+    bool isChannelBuiltin(const std::string& name) const {
+        static const std::set<std::string> builtins = {
+            "saluran", "kirim", "terima", "coba_kirim", "coba_terima", "tutup"
+        };
+        return builtins.count(name) > 0 && functions.find(name) == functions.end();
+    }
+    
+    // Channel builtins (after the name):
+    //   saluran(int|teks, n)     new channel holding up to n values
+    //   kirim(ch, x)             send, waiting for room; 0 once closed
+    //   terima(ch, x)            receive into variable x, waiting for a value;
+    //                            0 once closed and drained
+    //   coba_kirim(ch, x)        1 sent, 0 full, -1 closed
+    //   coba_terima(ch, x)       1 received, 0 empty, -1 closed and drained
+    //   tutup(ch)                close; receivers still drain what was sent
+    ExprResult generateChannelBuiltin(const std::string& name) {
+        Token tok = current();
+        usesChannels = true;
+        expect(TokenType::LPAREN, "Expected '(' after '" + name + "'");
+        if (name == "saluran") {
+            ExprType element = parseTypeName();
+            expect(TokenType::COMMA, "Expected ',' between arguments");
+            auto capacity = generateTypedExpression();
+            expect(TokenType::RPAREN, "Expected ')'");
+            return ExprResult("__wear_chan_new(" + capacity.code + ")",
+                              element == ExprType::STRING ? ExprType::STRING_CHANNEL : ExprType::INT_CHANNEL);
+        }
+        
+        auto channel = generateTypedExpression();
+        if (!isChannelType(channel.type)) {
+            std::cerr << "Error at line " << tok.line << ": " << name << " expects a channel from saluran" << std::endl;
+            std::exit(1);
+        }
+        bool text = channel.type == ExprType::STRING_CHANNEL;
+        std::string suffix = text ? "_str(" : "_int(";
+        std::string code;
+        if (name == "tutup") {
+            code = "__wear_tutup(" + channel.code + ")";
+        } else if (name == "kirim" || name == "coba_kirim") {
+            expect(TokenType::COMMA, "Expected ',' between arguments");
+            auto value = generateTypedExpression();
+            bool number = value.type == ExprType::INT || value.type == ExprType::UNKNOWN;
+            if (text ? !number && value.type != ExprType::STRING && value.type != ExprType::VIEW : !number) {
+                std::cerr << "Error at line " << tok.line << ": " << name << " sends "
+                          << (text ? "teks" : "int") << " values on this channel" << std::endl;
+                std::exit(1);
+            }
+            std::string arg = text && number ? "__wear_int_to_str(" + value.code + ")"
+                                             : coerce(value, text ? ExprType::STRING : ExprType::INT);
+            code = "__wear_" + name + suffix + channel.code + ", " + arg + ")";
+        } else {
+            // The received value goes into a variable of the element type
+            expect(TokenType::COMMA, "Expected ',' between arguments");
+            Token target = current();
+            ExprType type = target.type == TokenType::IDENTIFIER ? varType(target.value) : ExprType::UNKNOWN;
+            if (target.type != TokenType::IDENTIFIER || !varTypes.count(target.value) ||
+                type != (text ? ExprType::STRING : ExprType::INT) || peek().type != TokenType::RPAREN) {
+                std::cerr << "Error at line " << tok.line << ": " << name << " needs "
+                          << (text ? "a teks" : "an int") << " variable to receive into, e.g. "
+                          << name << "(ch, x)" << std::endl;
+                std::exit(1);
+            }
+            advance();
+            code = "__wear_" + name + suffix + channel.code + ", &" + target.value + ")";
+        }
+        expect(TokenType::RPAREN, "Expected ')'");
+        return ExprResult(code, ExprType::INT);
+    }
+    
+    // atomik, muat, simpan, ambil_tambah and tukar_jika are builtins
+    // unless the program defines a function of that name
+    bool isAtomicBuiltin(const std::string& name) const {
+        static const std::set<std::string> builtins = {
+            "atomik", "muat", "simpan", "ambil_tambah", "tukar_jika"
+        };
+        return builtins.count(name) > 0 && functions.find(name) == functions.end();
+    }
+    
+    // Atomic int builtins (after the name):
+    //   atomik(x)                  new atomic int holding x
+    //   muat(a), simpan(a, x)      read / write (simpan gives x)
+    //   ambil_tambah(a, x)         add x, give the value before
+    //   tukar_jika(a, lama, baru)  set to baru if it is lama; 1 when it was
+    ExprResult generateAtomicBuiltin(const std::string& name) {
+        Token tok = current();
+        usesAtomics = true;
+        expect(TokenType::LPAREN, "Expected '(' after '" + name + "'");
+        std::vector<std::string> args;
+        while (!check(TokenType::RPAREN) && !check(TokenType::END_OF_FILE)) {
+            if (!args.empty()) expect(TokenType::COMMA, "Expected ',' between arguments");
+            auto arg = generateTypedExpression();
+            bool number = arg.type == ExprType::INT || arg.type == ExprType::UNKNOWN;
+            if (args.empty() && name != "atomik" ? arg.type != ExprType::ATOMIC_INT : !number) {
+                std::cerr << "Error at line " << tok.line << ": " << name << " expects "
+                          << (args.empty() && name != "atomik" ? "an atomik from atomik(x)" : "int values")
+                          << std::endl;
+                std::exit(1);
+            }
+            args.push_back(arg.code);
+        }
+        expect(TokenType::RPAREN, "Expected ')'");
+        
+        size_t arity = name == "tukar_jika" ? 3 : name == "simpan" || name == "ambil_tambah" ? 2 : 1;
+        if (args.size() != arity) {
+            std::cerr << "Error at line " << tok.line << ": " << name << " takes " << arity
+                      << " argument" << (arity > 1 ? "s" : "") << std::endl;
+            std::exit(1);
+        }
+        std::string code = "__wear_" + name + "(";
+        for (size_t i = 0; i < args.size(); i++) code += (i > 0 ? ", " : "") + args[i];
+        return ExprResult(code + ")", name == "atomik" ? ExprType::ATOMIC_INT : ExprType::INT);
+    }
+    
+    // 'baca_banyak(paths)' (after the name): the contents of every file in
+    // a teks array, read as one batch; a builtin unless the program defines
+    // a function of that name
+    ExprResult generateReadMany() {
+        Token tok = current();
+        usesFiles = true;
+        expect(TokenType::LPAREN, "Expected '(' after 'baca_banyak'");
+        auto paths = generateTypedExpression();
+        expect(TokenType::RPAREN, "Expected ')'");
+        if (paths.type != ExprType::STRING_ARRAY && paths.type != ExprType::VIEW_ARRAY) {
+            std::cerr << "Error at line " << tok.line << ": baca_banyak expects an array of file paths" << std::endl;
+            std::exit(1);
+        }
+        std::string kind = paths.type == ExprType::VIEW_ARRAY ? "2" : "1";
+        return ExprResult("__wear_baca_banyak(" + paths.code + ", " + kind + ")", ExprType::STRING_ARRAY);
+    }
+    
+    // Whether calling 'name' may wait on a channel (kirim/terima, directly
+    // or in a function it calls)
+    bool mayBlockOnChannel(const std::string& name, std::set<std::string>& seen) const {
+        auto it = functions.find(name);
+        if (it == functions.end() || !seen.insert(name).second) return false;
+        for (size_t i = it->second.bodyStart; i + 1 < it->second.end; i++) {
+            if (tokens[i].type != TokenType::IDENTIFIER || tokens[i + 1].type != TokenType::LPAREN) continue;
+            const std::string& callee = tokens[i].value;
+            if ((callee == "kirim" || callee == "terima") && isChannelBuiltin(callee)) return true;
+            if (mayBlockOnChannel(callee, seen)) return true;
+        }
+        return false;
+    }
+    
+    // 'jalankan f(x, y)': the arguments are evaluated here and f runs as a
+    // task. Each spawn site gets a struct for the arguments, a run
+    // function and a spawn function. An operand that is no longer a call
+    // (e.g. folded at compile time) gives a task that is already done
+    ExprResult generateSpawn() {
+        Token keyword = current();
+        advance(); // skip 'jalankan'
+        usesTasks = true;
+        if (!check(TokenType::IDENTIFIER) || peek().type != TokenType::LPAREN ||
+            functions.find(current().value) == functions.end()) {
+            auto value = generateTypedExpression();
+            if (value.type == ExprType::STRING || value.type == ExprType::VIEW) {
+                return ExprResult("__wear_task_done_str(" + asCString(value) + ")", ExprType::STRING_TASK);
+            }
+            if (isArrayType(value.type) || isTaskType(value.type)) {
+                std::cerr << "Error at line " << keyword.line
+                          << ": jalankan runs functions returning int or teks" << std::endl;
+                std::exit(1);
+            }
+            return ExprResult("__wear_task_done_int(" + value.code + ")", ExprType::INT_TASK);
+        }
+        
+        std::string name = current().value;
+        if (isGenerator(name)) {
+            std::cerr << "Error at line " << keyword.line << ": jalankan cannot run generator '" << name << "'"
+                      << std::endl;
+            std::exit(1);
+        }
+        advance();
+        std::string callee;
+        std::vector<ExprResult> args;
+        ExprType result = generateCallArguments(name, callee, args);
+        if (isArrayType(result) || isTaskType(result)) {
+            std::cerr << "Error at line " << keyword.line
+                      << ": jalankan runs functions returning int or teks" << std::endl;
+            std::exit(1);
+        }
+        bool text = result == ExprType::STRING || result == ExprType::VIEW;
+        std::string spawn = "__wear_jalankan" + programNumber('w', ++workerCounter);
+        
+        std::string params;
+        std::string fields;
+        std::string values;
+        std::string call;
+        for (size_t i = 0; i < args.size(); i++) {
+            std::string arg = "a" + std::to_string(i);
+            params += (i > 0 ? ", " : "") + cTypeName(args[i].type) + " " + arg;
+            fields += "    " + cTypeName(args[i].type) + " " + arg + ";\n";
+            values += "    s->" + arg + " = " + arg + ";\n";
+            call += (i > 0 ? ", s->" : "s->") + arg;
+        }
+        call = callee + "(" + call + ")";
+        if (result == ExprType::VIEW) call = "__wear_view_str(" + call + ")";
+        
+        std::ostringstream code;
+        code << "typedef struct {\n    __wear_task task;\n" << fields << "} " << spawn << "_args;\n\n";
+        code << "static void " << spawn << "_run(__wear_task* t) {\n";
+        code << "    " << spawn << "_args* s = (" << spawn << "_args*)t;\n";
+        code << "    (void)s;\n";
+        code << "    t->result." << (text ? "s" : "i") << " = " << call << ";\n";
+        code << "}\n\n";
+        code << "static __wear_task* " << spawn << "(" << (params.empty() ? "void" : params) << ") {\n";
+        code << "    " << spawn << "_args* s = (" << spawn << "_args*)__wear_task_new(sizeof(" << spawn
+             << "_args), " << spawn << "_run);\n";
+        code << values;
+        std::set<std::string> seen;
+        code << "    return __wear_task_" << (mayBlockOnChannel(name, seen) ? "start" : "spawn") << "(&s->task);\n";
+        code << "}\n\n";
+        workersOutput << code.str();
+        
+        std::string arguments;
+        for (size_t i = 0; i < args.size(); i++) arguments += (i > 0 ? ", " : "") + args[i].code;
+        return ExprResult(spawn + "(" + arguments + ")", text ? ExprType::STRING_TASK : ExprType::INT_TASK);
+    }
+    
+    // 'tunggu t': the result of the task, once it has finished
+    ExprResult generateAwait() {
+        Token keyword = current();
+        advance(); // skip 'tunggu'
+        ExprResult task;
+        if (check(TokenType::IDENTIFIER)) {
+            std::string name = current().value;
+            advance();
+            task = generateIndexing(ExprResult(name, varType(name)));
+        } else if (match(TokenType::LPAREN)) {
+            task = generateTypedExpression();
+            expect(TokenType::RPAREN, "Expected ')'");
+        }
+        if (!isTaskType(task.type)) {
+            std::cerr << "Error at line " << keyword.line << ": tunggu expects a task from jalankan" << std::endl;
+            std::exit(1);
+        }
+        if (task.type == ExprType::STRING_TASK) {
+            return ExprResult("__wear_tunggu_str(" + task.code + ")", ExprType::STRING);
+        }
+        return ExprResult("__wear_tunggu_int(" + task.code + ")", ExprType::INT);
+    }
+    
+    // With stopAtPlus the expression ends at the next top-level '+' (one
+    // operand of a string concatenation)
+    ExprResult generateTypedExpression(bool stopAtPlus = false) {
+        std::vector<std::pair<std::string, ExprType>> parts;
+        
+        while (!check(TokenType::END_OF_FILE)) {
+            Token tok = current();
+            
+            // Stop conditions
+            if ((stopAtPlus && tok.type == TokenType::PLUS) ||
+                pos == expressionEnd ||
+                tok.type == TokenType::RPAREN ||
+                tok.type == TokenType::RBRACKET ||
+                tok.type == TokenType::LBRACE ||
+                tok.type == TokenType::RBRACE ||
+                tok.type == TokenType::COMMA ||
+                tok.type == TokenType::SEMICOLON ||
+                tok.type == TokenType::NEWLINE) {
+                break;
+            }
+            
+            if (tok.type == TokenType::STRING) {
+                parts.push_back({"\"" + tok.value + "\"", ExprType::STRING});
+                advance();
+            } else if (tok.type == TokenType::INTEGER) {
+                parts.push_back({tok.value, ExprType::INT});
+                advance();
+            } else if (tok.type == TokenType::BACA_FILE) {
+                // baca_file("filename")
+                advance();
+                expect(TokenType::LPAREN, "Expected '(' after 'baca_file'");
+                auto arg = generateTypedExpression();
+                expect(TokenType::RPAREN, "Expected ')'");
+                parts.push_back({"__wear_read_file(" + asCString(arg) + ")", ExprType::STRING});
+            } else if (tok.type == TokenType::SAMA) {
+                // sama(str1, str2) - string comparison
+                advance();
+                expect(TokenType::LPAREN, "Expected '(' after 'sama'");
+                auto arg1 = generateTypedExpression();
+                expect(TokenType::COMMA, "Expected ',' between arguments");
+                auto arg2 = generateTypedExpression();
+                expect(TokenType::RPAREN, "Expected ')'");
+                if (arg1.type == ExprType::VIEW || arg2.type == ExprType::VIEW) {
+                    parts.push_back({"__wear_view_eq(" + asView(arg1) + ", " + asView(arg2) + ")", ExprType::INT});
+                } else {
+                    parts.push_back({"__wear_streq(" + arg1.code + ", " + arg2.code + ")", ExprType::INT});
+                }
+            } else if (tok.type == TokenType::PANJANG) {
+                // panjang(str) - string length (or array length)
+                advance();
+                expect(TokenType::LPAREN, "Expected '(' after 'panjang'");
+                auto arg = generateTypedExpression();
+                expect(TokenType::RPAREN, "Expected ')'");
+                if (arg.type == ExprType::VIEW) {
+                    parts.push_back({"(" + arg.code + ").len", ExprType::INT});
+                } else if (isArrayType(arg.type)) {
+                    parts.push_back({"(" + arg.code + ")->length", ExprType::INT});
+                } else {
+                    parts.push_back({"__wear_strlen(" + arg.code + ")", ExprType::INT});
+                }
+            } else if (tok.type == TokenType::CHAR_AT) {
+                // char_at(str, index) - character at index
+                advance();
+                expect(TokenType::LPAREN, "Expected '(' after 'char_at'");
+                auto str = generateTypedExpression();
+                expect(TokenType::COMMA, "Expected ',' between arguments");
+                auto idx = generateTypedExpression();
+                expect(TokenType::RPAREN, "Expected ')'");
+                const char* helper = str.type == ExprType::VIEW ? "__wear_view_char_at(" : "__wear_char_at(";
+                parts.push_back({helper + str.code + ", " + idx.code + ")", ExprType::STRING});
+            } else if (tok.type == TokenType::IS_QUOTE) {
+                // is_quote(char) - check if character is quote
+                advance();
+                expect(TokenType::LPAREN, "Expected '(' after 'is_quote'");
+                auto arg = generateTypedExpression();
+                expect(TokenType::RPAREN, "Expected ')'");
+                parts.push_back({"__wear_is_quote(" + asCString(arg) + ")", ExprType::INT});
+            } else if (tok.type == TokenType::QUOTE_CHAR) {
+                // quote_char() - get quote character as string
+                advance();
+                expect(TokenType::LPAREN, "Expected '(' after 'quote_char'");
+                expect(TokenType::RPAREN, "Expected ')'");
+                parts.push_back({"__wear_quote_char()", ExprType::STRING});
+            } else if (tok.type == TokenType::IS_NEWLINE) {
+                // is_newline(char) - check if character is newline
+                advance();
+                expect(TokenType::LPAREN, "Expected '(' after 'is_newline'");
+                auto arg = generateTypedExpression();
+                expect(TokenType::RPAREN, "Expected ')'");
+                parts.push_back({"__wear_is_newline(" + asCString(arg) + ")", ExprType::INT});
+            } else if (tok.type == TokenType::NEWLINE_CHAR) {
+                // newline_char() - get newline character as string
+                advance();
+                expect(TokenType::LPAREN, "Expected '(' after 'newline_char'");
+                expect(TokenType::RPAREN, "Expected ')'");
+                parts.push_back({"__wear_newline_char()", ExprType::STRING});
+            } else if (tok.type == TokenType::KODE_AT) {
+                // kode_at(str, index) - byte at index as int
+                advance();
+                expect(TokenType::LPAREN, "Expected '(' after 'kode_at'");
+                auto str = generateTypedExpression();
+                expect(TokenType::COMMA, "Expected ',' between arguments");
+                auto idx = generateTypedExpression();
+                expect(TokenType::RPAREN, "Expected ')'");
+                const char* helper = str.type == ExprType::VIEW ? "__wear_view_kode_at(" : "__wear_kode_at(";
+                parts.push_back({helper + str.code + ", " + idx.code + ")", ExprType::INT});
+            } else if (tok.type == TokenType::IS_DIGIT_KODE) {
+                // is_digit_kode(code) - check if byte code is digit
+                advance();
+                expect(TokenType::LPAREN, "Expected '(' after 'is_digit_kode'");
+                auto arg = generateTypedExpression();
+                expect(TokenType::RPAREN, "Expected ')'");
+                parts.push_back({"__wear_is_digit_kode(" + arg.code + ")", ExprType::INT});
+            } else if (tok.type == TokenType::IS_LETTER_KODE) {
+                // is_letter_kode(code) - check if byte code is letter
+                advance();
+                expect(TokenType::LPAREN, "Expected '(' after 'is_letter_kode'");
+                auto arg = generateTypedExpression();
+                expect(TokenType::RPAREN, "Expected ')'");
+                parts.push_back({"__wear_is_letter_kode(" + arg.code + ")", ExprType::INT});
+            } else if (tok.type == TokenType::POTONG) {
+                // potong(str, start, len) - substring view, no copy
+                advance();
+                expect(TokenType::LPAREN, "Expected '(' after 'potong'");
+                auto str = generateTypedExpression();
+                expect(TokenType::COMMA, "Expected ',' between arguments");
+                auto start = generateTypedExpression();
+                expect(TokenType::COMMA, "Expected ',' between arguments");
+                auto len = generateTypedExpression();
+                expect(TokenType::RPAREN, "Expected ')'");
+                parts.push_back({"__wear_view_slice(" + asView(str) + ", " + start.code + ", " + len.code + ")",
+                                 ExprType::VIEW});
+            } else if (tok.type == TokenType::PISAH) {
+                // pisah(str, delim) - array of views between the delimiters
+                advance();
+                expect(TokenType::LPAREN, "Expected '(' after 'pisah'");
+                auto str = generateTypedExpression();
+                expect(TokenType::COMMA, "Expected ',' between arguments");
+                auto delim = generateTypedExpression();
+                expect(TokenType::RPAREN, "Expected ')'");
+                auto fields = generateIndexing(ExprResult("__wear_pisah(" + asView(str) + ", " + asView(delim) + ")",
+                                                          ExprType::VIEW_ARRAY));
+                parts.push_back({fields.code, fields.type});
+            } else if (tok.type == TokenType::COCOK) {
+                // cocok(str, /pattern/) - 1 when the pattern matches
+                advance();
+                expect(TokenType::LPAREN, "Expected '(' after 'cocok'");
+                auto str = generateTypedExpression();
+                expect(TokenType::COMMA, "Expected ',' between arguments");
+                if (!check(TokenType::REGEX)) {
+                    std::cerr << "Error at line " << current().line
+                              << ": cocok expects a /pattern/ literal" << std::endl;
+                    std::exit(1);
+                }
+                std::string dfa = patternTable(current());
+                advance();
+                expect(TokenType::RPAREN, "Expected ')'");
+                parts.push_back({"__wear_dfa_match(" + asView(str) + ", &" + dfa + ")", ExprType::INT});
+            } else if (tok.type == TokenType::URUTKAN) {
+                // urutkan(array) - sort in place, returns the array
+                advance();
+                expect(TokenType::LPAREN, "Expected '(' after 'urutkan'");
+                auto array = generateTypedExpression();
+                expect(TokenType::RPAREN, "Expected ')'");
+                if (!isArrayType(array.type)) {
+                    std::cerr << "Error at line " << tok.line << ": urutkan expects an array" << std::endl;
+                    std::exit(1);
+                }
+                int kind = array.type == ExprType::INT_ARRAY ? 0 : array.type == ExprType::STRING_ARRAY ? 1 : 2;
+                usesSort = true;
+                auto sorted = generateIndexing(ExprResult("__wear_urutkan(" + array.code + ", " +
+                                                          std::to_string(kind) + ")", array.type));
+                parts.push_back({sorted.code, sorted.type});
+            } else if (tok.type == TokenType::JALANKAN) {
+                auto task = generateSpawn();
+                parts.push_back({task.code, task.type});
+            } else if (tok.type == TokenType::TUNGGU) {
+                auto result = generateAwait();
+                parts.push_back({result.code, result.type});
+            } else if (tok.type == TokenType::LBRACKET) {
+                auto array = generateIndexing(generateArrayLiteral());
+                parts.push_back({array.code, array.type});
+            } else if (tok.type == TokenType::IDENTIFIER) {
+                std::string name = tok.value;
+                advance();
+                
+                // Check for function call
+                if (check(TokenType::LPAREN)) {
+                    auto call = generateIndexing(generateCall(name));
+                    parts.push_back({call.code, call.type});
+                } else {
+                    // Variable reference (or an element of an array variable)
+                    auto value = generateIndexing(ExprResult(name, varType(name)));
+                    parts.push_back({value.code, value.type});
+                }
+            } else if (tok.type == TokenType::PLUS) {
+                parts.push_back({"+", ExprType::UNKNOWN});
+                advance();
+            } else if (tok.type == TokenType::MINUS) {
+                parts.push_back({"-", ExprType::UNKNOWN});
+                advance();
+            } else if (tok.type == TokenType::STAR) {
+                parts.push_back({"*", ExprType::UNKNOWN});
+                advance();
+            } else if (tok.type == TokenType::SLASH) {
+                parts.push_back({"/", ExprType::UNKNOWN});
+                advance();
+            } else if (tok.type == TokenType::LESS) {
+                parts.push_back({"<", ExprType::UNKNOWN});
+                advance();
+            } else if (tok.type == TokenType::GREATER) {
+                parts.push_back({">", ExprType::UNKNOWN});
+                advance();
+            } else if (tok.type == TokenType::LESS_EQUAL) {
+                parts.push_back({"<=", ExprType::UNKNOWN});
+                advance();
+            } else if (tok.type == TokenType::GREATER_EQUAL) {
+                parts.push_back({">=", ExprType::UNKNOWN});
+                advance();
+            } else if (tok.type == TokenType::EQUAL_EQUAL) {
+                parts.push_back({"==", ExprType::UNKNOWN});
+                advance();
+            } else if (tok.type == TokenType::NOT_EQUAL) {
+                parts.push_back({"!=", ExprType::UNKNOWN});
+                advance();
+            } else if (tok.type == TokenType::QUESTION) {
+                parts.push_back({" ? ", ExprType::UNKNOWN});
+                advance();
+            } else if (tok.type == TokenType::COLON) {
+                parts.push_back({" : ", ExprType::UNKNOWN});
+                advance();
+            } else if (tok.type == TokenType::LPAREN) {
+                // Parenthesized group is a single operand with its own type
+                advance();
+                auto inner = generateTypedExpression();
+                expect(TokenType::RPAREN, "Expected ')'");
+                auto group = generateIndexing(ExprResult("(" + inner.code + ")", inner.type));
+                parts.push_back({group.code, group.type});
+            } else {
+                break;
+            }
+        }
+        
+        // Check if this is a string concatenation expression
+        bool hasString = false;
+        bool hasPlus = false;
+        for (const auto& p : parts) {
+            if (p.second != ExprType::INT && p.second != ExprType::UNKNOWN) hasString = true;
+            if (p.first == "+") hasPlus = true;
+        }
+        
+        if (hasString && hasPlus && parts.size() >= 3) {
+            // Build string concatenation chain
+            return buildStringConcat(parts);
+        }
+        
+        // Regular expression; next to a string (e.g. the other branch of an
+        // inlined '?:') a view is copied
+        ExprType resultType = ExprType::INT;
+        for (const auto& p : parts) {
+            if (p.second == ExprType::STRING) {
+                resultType = ExprType::STRING;
+            } else if (resultType == ExprType::INT && p.second != ExprType::INT && p.second != ExprType::UNKNOWN) {
+                resultType = p.second;
+            }
+        }
+        std::ostringstream result;
+        for (const auto& p : parts) {
+            bool copy = resultType == ExprType::STRING && p.second == ExprType::VIEW;
+            result << (copy ? asCString(ExprResult(p.first, p.second)) : p.first);
+        }
+        
+        return ExprResult(result.str(), resultType);
+    }
+    
+    ExprResult buildStringConcat(const std::vector<std::pair<std::string, ExprType>>& parts) {
+        // Build a chain of __wear_concat calls; everything between two '+'
+        // (e.g. a * 2) forms one operand
+        std::vector<std::pair<std::string, ExprType>> operands;
+        std::pair<std::string, ExprType> operand("", ExprType::INT);
+        
+        for (const auto& p : parts) {
+            if (p.first == "+") {
+                if (!operand.first.empty()) operands.push_back(operand);
+                operand = {"", ExprType::INT};
+            } else if (isArrayType(p.second)) {
+                operand.first += arrayText(ExprResult(p.first, p.second));
+                operand.second = ExprType::STRING;
+            } else {
+                operand.first += p.first;
+                if (p.second == ExprType::STRING) operand.second = ExprType::STRING;
+                if (p.second == ExprType::VIEW && operand.second == ExprType::INT) operand.second = ExprType::VIEW;
+            }
+        }
+        if (!operand.first.empty()) operands.push_back(operand);
+        
+        if (operands.empty()) {
+            return ExprResult("\"\"", ExprType::STRING);
+        }
+        
+        if (operands.size() == 1) {
+            return ExprResult(operands[0].first, operands[0].second);
+        }
+        
+        // Build nested concat calls; views are appended straight from the
+        // parent buffer
+        std::string result = asCString(ExprResult(operands[0].first, operands[0].second));
+        ExprType prevType = operands[0].second == ExprType::VIEW ? ExprType::STRING : operands[0].second;
+        
+        for (size_t i = 1; i < operands.size(); i++) {
+            std::string op = operands[i].first;
+            ExprType opType = operands[i].second;
+            
+            if (opType == ExprType::VIEW) {
+                std::string left = prevType == ExprType::STRING ? result : "__wear_int_to_str(" + result + ")";
+                result = "__wear_concat_view(" + left + ", " + op + ")";
+            } else if (prevType == ExprType::STRING && opType == ExprType::STRING) {
+                result = "__wear_concat(" + result + ", " + op + ")";
+            } else if (prevType == ExprType::STRING) {
+                result = "__wear_concat_str_int(" + result + ", " + op + ")";
+            } else if (opType == ExprType::STRING) {
+                result = "__wear_concat_int_str(" + result + ", " + op + ")";
+            } else {
+                // Both int - just add
+                result = "(" + result + " + " + op + ")";
+            }
+            
+            // Result of concat is always string
+            if (prevType == ExprType::STRING || opType != ExprType::INT) {
+                prevType = ExprType::STRING;
+            }
+        }
+        
+        return ExprResult(result, ExprType::STRING);
+    }
+    
+    // Simple expression for conditions (no string concat)
+    std::string generateExpression() {
+        auto result = generateTypedExpression();
+        return result.code;
+    }
+    
+    // Generate print statement
+    void generatePrint() {
+        advance(); // skip 'cetak'
+        
+        auto expr = generateTypedExpression();
+        
+        if (expr.type == ExprType::STRING) {
+            emitLine("__wear_print_str(" + expr.code + ");");
+        } else if (expr.type == ExprType::VIEW) {
+            emitLine("__wear_print_view(" + expr.code + ");");
+        } else if (isArrayType(expr.type)) {
+            emitLine("__wear_print_str(" + arrayText(expr) + ");");
+        } else {
+            emitLine("__wear_print_int(" + expr.code + ");");
+        }
+    }
+    
+    // Generate variable declaration
+    void generateVarDecl() {
+        advance(); // skip 'var'
+        
+        std::string varName = current().value;
+        advance(); // skip identifier
+        
+        expect(TokenType::EQUAL, "Expected '=' after variable name");
+        
+        // The whole initializer decides the type, so "a" + b stays one expression
+        auto expr = generateTypedExpression();
+        ExprType type = expr.type == ExprType::UNKNOWN ? ExprType::INT : expr.type;
+        if (inGenerator) {
+            // Declared on entry to the generator, which keeps it across hasilkan
+            declareGeneratorLocal(varName, type, tokens[pos - 1].line);
+            emitLine(varName + " = " + expr.code + ";");
+        } else {
+            emitLine(cTypeName(type) + " " + varName + " = " + expr.code + ";");
+        }
+        varTypes[varName] = type;
+    }
+    
+    // ============================================================
+    // Scanning loop idioms
+    // ============================================================
+    //
+    // Two loop shapes walk a string one character at a time:
+    //
+    //   selama (j < total) {             selama (scanning == 1) {
+    //       var c = char_at(src, j)          jika (j >= total) {
+    //       jika (<class of c>) {                scanning = 0
+    //           [w = w + c]                  } lainnya {
+    //           j = j + 1                        var c = char_at(src, j)
+    //       } lainnya {                          jika (<class of c>) { [w = w + c]  j = j + 1 }
+    //           j = total                        lainnya { scanning = 0  ... }
+    //       }                                }
+    //   }                                }
+    //
+    // The branch conditions are evaluated for every byte at compile time;
+    // the loop becomes one __wear_span_class (class table) or
+    // __wear_find_byte (memchr) call plus a single append of the range.
+    
+    // One arm of the per-character 'jika' chain
+    struct ScanBranch {
+        size_t condition = 0;    // Token index of the condition (0 for 'lainnya')
+        size_t block = 0;        // Token index of '{'
+        bool advances = false;   // 'j = j + 1': keep scanning
+        std::string appendsTo;   // 'w = w + c' target, if any
+    };
+    
+    struct ScanLoop {
+        bool flagForm = false;
+        std::string index, limit, source, character, accumulator, flag;
+        std::vector<size_t> prelude;   // 'var c = ...' and 'var t = <expr of c>' statements
+        size_t stopBlock = 0;          // Arm run at the stopping character (flag form)
+        size_t end = 0;                // Token index just past the loop
+        unsigned char table[256] = {}; // 1 = keep scanning; entry 0 is for ""
+    };
+    
+    std::map<std::string, std::string> scanTables;   // Table contents -> C name
+    std::ostringstream scanTablesOutput;
+    std::map<std::string, std::string> patternTables;   // cocok pattern -> C name
+    std::ostringstream patternTablesOutput;
+    
+    // C name of the class table with these 256 entries, emitting it on first use
+    std::string scanClassTable(const std::string& contents) {
+        auto known = scanTables.find(contents);
+        if (known != scanTables.end()) return known->second;
+        if (isWorker) {
+            deferredScans.push_back(contents);
+            return scanTables[contents] = programNumber('s', (int)deferredScans.size());
+        }
+        std::string name = "__wear_scan_class" + std::to_string(scanTables.size() + 1);
+        scanTablesOutput << "static const unsigned char " << name << "[256] = {";
+        for (int b = 0; b < 256; b++) {
+            int entry = (unsigned char)contents[b];
+            scanTablesOutput << (b % 32 == 0 ? "\n    " : "") << entry << (b < 255 ? "," : "");
+        }
+        scanTablesOutput << "\n};\n";
+        scanTables[contents] = name;
+        return name;
+    }
+    
+    // C name of the DFA for a /pattern/ token, emitting its tables on first use
+    std::string patternTable(const Token& literal) {
+        auto known = patternTables.find(literal.value);
+        if (known != patternTables.end()) return known->second;
+        if (isWorker) {
+            deferredPatterns.push_back(literal);
+            return patternTables[literal.value] = programNumber('p', (int)deferredPatterns.size());
+        }
+        
+        RegexDfa dfa;
+        std::string error;
+        if (!RegexCompiler::compile(literal.value, dfa, error)) {
+            std::cerr << "Error at line " << literal.line << ": Invalid pattern /" << literal.value
+                      << "/: " << error << std::endl;
+            std::exit(1);
+        }
+        
+        // Bytes every state treats alike share one column
+        std::map<std::vector<int>, int> columnOf;
+        std::vector<int> classes(256);
+        for (int b = 0; b < 256; b++) {
+            std::vector<int> column;
+            for (const auto& row : dfa.next) column.push_back(row[b]);
+            classes[b] = columnOf.emplace(column, (int)columnOf.size()).first->second;
+        }
+        std::vector<std::vector<int>> columns(columnOf.size());
+        for (const auto& entry : columnOf) columns[entry.second] = entry.first;
+        
+        int dead = -1;
+        for (size_t st = 0; st < dfa.next.size() && dead < 0; st++) {
+            bool trapped = !dfa.accept[st];
+            for (int b = 0; b < 256 && trapped; b++) trapped = dfa.next[st][b] == (int)st;
+            if (trapped) dead = (int)st;
+        }
+        
+        std::string name = "__wear_pattern" + std::to_string(patternTables.size() + 1);
+        std::ostringstream& out = patternTablesOutput;
+        std::string shown = "/" + literal.value + "/";
+        for (size_t at = shown.find("*/"); at != std::string::npos; at = shown.find("*/", at)) {
+            shown.insert(at + 1, "\\");   // Keep the comment closed
+        }
+        out << "/* " << shown << " */\n";
+        out << "static const unsigned char " << name << "_classes[256] = {";
+        for (int b = 0; b < 256; b++) out << (b % 32 == 0 ? "\n    " : "") << classes[b] << (b < 255 ? "," : "");
+        out << "\n};\n";
+        out << "static const unsigned short " << name << "_next[] = {";
+        for (size_t st = 0; st < dfa.next.size(); st++) {
+            out << "\n   ";
+            for (const auto& column : columns) out << " " << column[st] << ",";
+        }
+        out << "\n};\n";
+        out << "static const unsigned char " << name << "_accept[] = {";
+        for (size_t st = 0; st < dfa.accept.size(); st++) out << (st > 0 ? ", " : "") << (int)dfa.accept[st];
+        out << "};\n";
+        out << "static const __wear_dfa " << name << " = {" << name << "_classes, " << name << "_next, "
+            << name << "_accept, " << columns.size() << ", " << dfa.start << ", " << dead << ", "
+            << (dfa.anchoredEnd ? 0 : 1) << "};\n\n";
+        patternTables[literal.value] = name;
+        return name;
+    }
+    
+    // [start, end) of each statement directly inside the block at tokens[lbrace]
+    std::vector<std::pair<size_t, size_t>> blockStatements(size_t lbrace) const {
+        std::vector<std::pair<size_t, size_t>> statements;
+        size_t close = skipBlock(tokens, lbrace) - 1;
+        size_t i = lbrace + 1;
+        while (i < close) {
+            if (tokens[i].type == TokenType::NEWLINE) {
+                i++;
+                continue;
+            }
+            size_t start = i;
+            for (int depth = 0; i < close; i++) {
+                TokenType t = tokens[i].type;
+                if (t == TokenType::NEWLINE && depth == 0) break;
+                if (t == TokenType::LBRACE || t == TokenType::LPAREN) depth++;
+                if (t == TokenType::RBRACE || t == TokenType::RPAREN) depth--;
+            }
+            statements.push_back({start, i});
+        }
+        return statements;
+    }
+    
+    // Whether tokens[start, end) are exactly the given types (and values, where not empty)
+    bool tokensAre(size_t start, size_t end,
+                   const std::vector<std::pair<TokenType, std::string>>& expected) const {
+        if (end - start != expected.size()) return false;
+        for (size_t k = 0; k < expected.size(); k++) {
+            if (tokens[start + k].type != expected[k].first) return false;
+            if (!expected[k].second.empty() && tokens[start + k].value != expected[k].second) return false;
+        }
+        return true;
+    }
+    
+    // 'name = value' where value is one token
+    bool isSimpleAssign(std::pair<size_t, size_t> stmt, const std::string& name, const std::string& value) const {
+        return tokensAre(stmt.first, stmt.second, {{TokenType::IDENTIFIER, name}, {TokenType::EQUAL, ""}}) ||
+               (stmt.second - stmt.first == 3 &&
+                tokensAre(stmt.first, stmt.second - 1, {{TokenType::IDENTIFIER, name}, {TokenType::EQUAL, ""}}) &&
+                tokens[stmt.second - 1].value == value &&
+                (tokens[stmt.second - 1].type == TokenType::IDENTIFIER || tokens[stmt.second - 1].type == TokenType::INTEGER));
+    }
+    
+    // Parse 'jika (...) {...} lainnya jika (...) {...} lainnya {...}' at tokens[i]
+    bool parseScanChain(size_t i, std::vector<ScanBranch>& branches, size_t& after) const {
+        while (true) {
+            if (tokens[i].type != TokenType::JIKA || tokens[i + 1].type != TokenType::LPAREN) return false;
+            size_t close = i + 1;
+            for (int depth = 0; close < tokens.size(); close++) {
+                if (tokens[close].type == TokenType::LPAREN) depth++;
+                if (tokens[close].type == TokenType::RPAREN && --depth == 0) break;
+            }
+            if (close + 1 >= tokens.size() || tokens[close + 1].type != TokenType::LBRACE) return false;
+            ScanBranch branch;
+            branch.condition = i + 2;
+            branch.block = close + 1;
+            branches.push_back(branch);
+            
+            i = skipBlock(tokens, close + 1);
+            if (tokens[i].type != TokenType::LAINNYA) return false;   // Every byte must be decided
+            i++;
+            if (tokens[i].type == TokenType::JIKA) continue;
+            if (tokens[i].type != TokenType::LBRACE) return false;
+            ScanBranch last;
+            last.block = i;
+            branches.push_back(last);
+            after = skipBlock(tokens, i);
+            return true;
+        }
+    }
+    
+    // Recognize either scanning loop shape at tokens[loopStart] ('selama')
+    bool matchScanLoop(size_t loopStart, ScanLoop& scan) {
+        const auto ident = [](const std::string& v = "") { return std::make_pair(TokenType::IDENTIFIER, v); };
+        size_t i = loopStart;
+        size_t body;
+        if (tokensAre(i + 1, i + 6, {{TokenType::LPAREN, ""}, ident(), {TokenType::LESS, ""},
+                                     ident(), {TokenType::RPAREN, ""}}) ||
+            tokensAre(i + 1, i + 6, {{TokenType::LPAREN, ""}, ident(), {TokenType::LESS, ""},
+                                     {TokenType::INTEGER, ""}, {TokenType::RPAREN, ""}})) {
+            scan.index = tokens[i + 2].value;
+            scan.limit = tokens[i + 4].value;
+            body = i + 6;
+        } else if (tokensAre(i + 1, i + 6, {{TokenType::LPAREN, ""}, ident(), {TokenType::EQUAL_EQUAL, ""},
+                                            {TokenType::INTEGER, "1"}, {TokenType::RPAREN, ""}})) {
+            scan.flagForm = true;
+            scan.flag = tokens[i + 2].value;
+            body = i + 6;
+        } else {
+            return false;
+        }
+        if (tokens[body].type != TokenType::LBRACE) return false;
+        scan.end = skipBlock(tokens, body);
+        
+        // Flag form: 'jika (j >= total) { flag = 0 } lainnya { <scan body> }'
+        auto statements = blockStatements(body);
+        if (scan.flagForm) {
+            if (statements.size() != 1) return false;
+            size_t k = statements[0].first;
+            if (!tokensAre(k, k + 6, {{TokenType::JIKA, ""}, {TokenType::LPAREN, ""}, ident(),
+                                      {TokenType::GREATER_EQUAL, ""}, {tokens[k + 4].type, ""},
+                                      {TokenType::RPAREN, ""}}) ||
+                (tokens[k + 4].type != TokenType::IDENTIFIER && tokens[k + 4].type != TokenType::INTEGER) ||
+                tokens[k + 6].type != TokenType::LBRACE) {
+                return false;
+            }
+            scan.index = tokens[k + 2].value;
+            scan.limit = tokens[k + 4].value;
+            auto bound = blockStatements(k + 6);
+            if (bound.size() != 1 || !isSimpleAssign(bound[0], scan.flag, "0")) return false;
+            size_t elseAt = skipBlock(tokens, k + 6);
+            if (tokens[elseAt].type != TokenType::LAINNYA || tokens[elseAt + 1].type != TokenType::LBRACE ||
+                skipBlock(tokens, elseAt + 1) != statements[0].second) {
+                return false;
+            }
+            statements = blockStatements(elseAt + 1);
+        }
+        
+        // 'var c = char_at(src, j)', optional 'var t = ...' temporaries, then the chain
+        if (statements.size() < 2) return false;
+        size_t k = statements[0].first;
+        if (!tokensAre(k, statements[0].second,
+                       {{TokenType::VAR, ""}, ident(), {TokenType::EQUAL, ""}, {TokenType::CHAR_AT, ""},
+                        {TokenType::LPAREN, ""}, ident(), {TokenType::COMMA, ""}, ident(scan.index),
+                        {TokenType::RPAREN, ""}})) {
+            return false;
+        }
+        scan.character = tokens[k + 1].value;
+        scan.source = tokens[k + 5].value;
+        for (size_t s = 0; s + 1 < statements.size(); s++) {
+            if (tokens[statements[s].first].type != TokenType::VAR) return false;
+            scan.prelude.push_back(statements[s].first);
+        }
+        std::vector<ScanBranch> branches;
+        size_t after = 0;
+        if (!parseScanChain(statements.back().first, branches, after) || after != statements.back().second) {
+            return false;
+        }
+        
+        // Names involved must be distinct, typed as expected, and untouched by the prelude
+        std::set<std::string> names = {scan.index, scan.source, scan.character};
+        if (names.size() != 3 || names.count(scan.limit) || names.count(scan.flag) ||
+            !isStringVar(scan.source) || isStringVar(scan.index)) {
+            return false;
+        }
+        
+        // Classify the arms: keep scanning, or stop
+        size_t stops = 0;
+        for (auto& branch : branches) {
+            auto stmts = blockStatements(branch.block);
+            bool increments = false;
+            bool other = false;
+            for (const auto& stmt : stmts) {
+                if (tokensAre(stmt.first, stmt.second, {ident(scan.index), {TokenType::EQUAL, ""}, ident(scan.index),
+                                                        {TokenType::PLUS, ""}, {TokenType::INTEGER, "1"}})) {
+                    if (increments) other = true;
+                    increments = true;
+                } else if (branch.appendsTo.empty() &&
+                           tokensAre(stmt.first, stmt.second, {ident(), {TokenType::EQUAL, ""}, ident(tokens[stmt.first].value),
+                                                               {TokenType::PLUS, ""}, ident(scan.character)})) {
+                    branch.appendsTo = tokens[stmt.first].value;
+                } else {
+                    other = true;
+                }
+            }
+            branch.advances = increments && !other;
+            if (branch.advances) continue;
+            
+            stops++;
+            if (scan.flagForm) {
+                // Anything may happen here once, as long as it ends the loop
+                bool ends = false;
+                size_t close = skipBlock(tokens, branch.block);
+                for (size_t t = branch.block; t < close; t++) {
+                    if (tokens[t].type == TokenType::IDENTIFIER && tokens[t].value == scan.flag &&
+                        tokens[t + 1].type == TokenType::EQUAL) {
+                        if (tokens[t + 2].type != TokenType::INTEGER || tokens[t + 2].value != "0") return false;
+                        ends = true;
+                    }
+                    if (tokens[t].type == TokenType::SELAMA) return false;
+                }
+                bool topLevelEnd = false;
+                for (const auto& stmt : stmts) topLevelEnd = topLevelEnd || isSimpleAssign(stmt, scan.flag, "0");
+                if (!ends || !topLevelEnd) return false;
+                scan.stopBlock = branch.block;
+            } else if (stmts.size() != 1 || !isSimpleAssign(stmts[0], scan.index, scan.limit)) {
+                return false;
+            }
+        }
+        if (stops != 1) return false;
+        
+        // Every scanning arm appends to the same string (or none does)
+        bool first = true;
+        for (const auto& branch : branches) {
+            if (!branch.advances) continue;
+            if (first) scan.accumulator = branch.appendsTo;
+            else if (branch.appendsTo != scan.accumulator) return false;
+            first = false;
+        }
+        if (!scan.accumulator.empty() &&
+            (names.count(scan.accumulator) || scan.accumulator == scan.limit || scan.accumulator == scan.flag ||
+             !isStringVar(scan.accumulator))) {
+            return false;
+        }
+        
+        // Decide every byte at compile time ("" for entry 0)
+        ConstEvaluator evaluator(tokens, functions, pureFunctions);
+        std::vector<size_t> temporaries(scan.prelude.begin() + 1, scan.prelude.end());
+        for (int b = 0; b < 256; b++) {
+            std::unordered_map<std::string, ConstValue> bindings;
+            ConstValue c;
+            c.isString = true;
+            if (b != 0) c.text = std::string(1, (char)b);
+            bindings[scan.character] = c;
+            
+            const ScanBranch* taken = &branches.back();
+            for (const auto& branch : branches) {
+                if (branch.condition == 0) break;
+                ConstValue value;
+                if (!evaluator.evaluateWith(bindings, temporaries, branch.condition, value) || value.isString) {
+                    return false;
+                }
+                if (value.number != 0) {
+                    taken = &branch;
+                    break;
+                }
+            }
+            scan.table[b] = taken->advances ? 1 : 0;
+        }
+        return true;
+    }
+    
+    // Emit a recognized scanning loop as one primitive call
+    void generateScanLoop(const ScanLoop& scan) {
+        // Only one byte stops the scan: memchr, otherwise a class table
+        int stopByte = -1;
+        int stopCount = 0;
+        for (int b = 1; b < 256; b++) {
+            if (!scan.table[b]) {
+                stopByte = b;
+                stopCount++;
+            }
+        }
+        std::string call;
+        if (stopCount == 1) {
+            call = "__wear_find_byte(" + scan.source + ", " + scan.index + ", " + scan.limit + ", " +
+                   std::to_string(stopByte) + ", " + std::to_string(scan.table[0]) + ")";
+        } else {
+            call = "__wear_span_class(" + scan.source + ", " + scan.index + ", " + scan.limit + ", " +
+                   scanClassTable(std::string((const char*)scan.table, 256)) + ")";
+        }
+        
+        std::string append;
+        if (!scan.accumulator.empty()) {
+            auto builder = builderVars.find(scan.accumulator);
+            if (builder != builderVars.end()) {
+                append = "__wear_builder_append_range(&" + builder->second + ", " + scan.source + ", " +
+                         scan.index + ", __wear_scan_end);";
+            } else {
+                append = scan.accumulator + " = __wear_concat_range(" + scan.accumulator + ", " +
+                         scan.source + ", " + scan.index + ", __wear_scan_end);";
+            }
+        }
+        
+        std::string guard = scan.flagForm ? scan.flag + " == 1" : scan.index + " < " + scan.limit;
+        emitLine("if (" + guard + ") {");
+        indentLevel++;
+        emitLine("int __wear_scan_end = " + call + ";");
+        if (!append.empty()) emitLine(append);
+        
+        if (!scan.flagForm) {
+            // Either the limit was reached or the stopping arm set 'j = total'
+            emitLine(scan.index + " = " + scan.limit + ";");
+        } else {
+            emitLine(scan.index + " = __wear_scan_end;");
+            emitLine("if (" + scan.index + " >= " + scan.limit + ") {");
+            emitLine("    " + scan.flag + " = 0;");
+            emitLine("} else {");
+            indentLevel++;
+            
+            // The stopping arm runs once, with 'c' (and its temporaries) in scope
+            std::unordered_map<std::string, ExprType> outerTypes = varTypes;
+            size_t resume = pos;
+            for (size_t statement : scan.prelude) {
+                pos = statement;
+                generateStatement();
+            }
+            pos = scan.stopBlock + 1;
+            while (!check(TokenType::RBRACE) && !check(TokenType::END_OF_FILE)) {
+                generateStatement();
+            }
+            pos = resume;
+            varTypes = outerTypes;
+            
+            indentLevel--;
+            emitLine("}");
+        }
+        
+        indentLevel--;
+        emitLine("}");
+        pos = scan.end;
+    }
+    
+    // Whether tokens[i] starts 'name = name + ...' as a statement
+    bool isStringAppend(size_t i, const std::string& name) const {
+        return tokens[i].type == TokenType::IDENTIFIER && tokens[i].value == name && i > 0 &&
+               i + 3 < tokens.size() &&
+               (tokens[i - 1].type == TokenType::NEWLINE || tokens[i - 1].type == TokenType::LBRACE) &&
+               tokens[i + 1].type == TokenType::EQUAL &&
+               tokens[i + 2].type == TokenType::IDENTIFIER && tokens[i + 2].value == name &&
+               tokens[i + 3].type == TokenType::PLUS;
+    }
+    
+    // Strings this loop only grows with 's = s + ...': every mention of s in
+    // the loop is such an append, and no 'kembalikan' leaves the loop early
+    // (the string is materialized after it)
+    std::vector<std::string> findStringAccumulators(size_t loopStart) {
+        if (inGenerator) return {};   // A builder would not survive hasilkan
+        size_t end = loopStart;
+        while (end < tokens.size() && tokens[end].type != TokenType::LBRACE) end++;
+        for (int depth = 0; end < tokens.size(); end++) {
+            if (tokens[end].type == TokenType::LBRACE) depth++;
+            if (tokens[end].type == TokenType::RBRACE && --depth == 0) break;
+        }
+        
+        std::vector<std::string> accumulators;
+        std::set<std::string> seen;
+        for (size_t i = loopStart; i < end; i++) {
+            if (tokens[i].type == TokenType::KEMBALIKAN) return {};
+            const std::string& name = tokens[i].value;
+            if (!isStringAppend(i, name) || !seen.insert(name).second) continue;
+            if (!isStringVar(name) || builderVars.count(name)) continue;
+            
+            size_t mentions = 0;
+            size_t appends = 0;
+            for (size_t k = loopStart; k < end; k++) {
+                if (tokens[k].type != TokenType::IDENTIFIER || tokens[k].value != name) continue;
+                mentions++;
+                if (isStringAppend(k, name)) appends++;
+            }
+            if (mentions == 2 * appends) accumulators.push_back(name);
+        }
+        return accumulators;
+    }
+    
+    // 's = s + a + b' on a string held in a builder: append each operand
+    void generateBuilderAppend(const std::string& builder) {
+        advance(); // skip the variable itself
+        while (match(TokenType::PLUS)) {
+            auto operand = generateTypedExpression(true);
+            if (operand.code.empty()) continue;
+            if (operand.type == ExprType::STRING) {
+                emitLine("__wear_builder_append(&" + builder + ", " + operand.code + ");");
+            } else if (operand.type == ExprType::VIEW) {
+                emitLine("__wear_builder_append_view(&" + builder + ", " + operand.code + ");");
+            } else if (isArrayType(operand.type)) {
+                emitLine("__wear_builder_append(&" + builder + ", " + arrayText(operand) + ");");
+            } else {
+                emitLine("__wear_builder_append_int(&" + builder + ", " + operand.code + ");");
+            }
+        }
+    }
+    
+    // Generate while loop
+    // With tryParalel (and --auto-paralel) independent counted loops run in
+    // parallel
+    void generateWhile(bool tryParalel = true) {
+        size_t loopStart = pos;
+        
+        ScanLoop scan;
+        if (matchScanLoop(loopStart, scan)) {
+            generateScanLoop(scan);
+            return;
+        }
+        
+        if (autoParalel && tryParalel && !inParalel) {
+            CountedLoop loop;
+            std::string reason = analyzeCountedLoop(loopStart, loop);
+            int line = tokens[loopStart].line;
+            if (reason.empty()) {
+                std::string note = "parallelized above " + std::to_string(autoParalelMinTrips) + " iterations";
+                for (const auto& r : loop.reductions) {
+                    note += std::string(", kurangi(") + (r.op == 0 ? "+" : "*") + ": " + r.name + ")";
+                }
+                autoParalelNotes.emplace(line, note);
+                generateAutoParalel(loopStart, loop);
+                pos = loop.end + 1;
+                return;
+            }
+            autoParalelNotes.emplace(line, "not parallelized, " + reason);
+        }
+        
+        // Accumulated strings live in builders while the loop runs
+        std::vector<std::string> accumulators = findStringAccumulators(loopStart);
+        for (const auto& name : accumulators) {
+            std::string builder = "__wear_sb" + programNumber('b', ++builderCounter);
+            emitLine("__wear_builder " + builder + ";");
+            emitLine("__wear_builder_init(&" + builder + ", " + name + ");");
+            builderVars[name] = builder;
+        }
+        
+        advance(); // skip 'selama'
+        
+        expect(TokenType::LPAREN, "Expected '(' after 'selama'");
+        std::string condition = generateExpression();
+        expect(TokenType::RPAREN, "Expected ')' after condition");
+        
+        emitLine("while (" + condition + ") {");
+        
+        expect(TokenType::LBRACE, "Expected '{' to start while body");
+        indentLevel++;
+        
+        while (!check(TokenType::RBRACE) && !check(TokenType::END_OF_FILE)) {
+            generateStatement();
+        }
+        
+        indentLevel--;
+        expect(TokenType::RBRACE, "Expected '}' to end while body");
+        emitLine("}");
+        
+        for (const auto& name : accumulators) {
+            emitLine(name + " = __wear_builder_finish(&" + builderVars[name] + ");");
+            builderVars.erase(name);
+        }
+    }
+    
+    // ============================================================
+    // paralel loops
+    // ============================================================
+    //
+    //   paralel (i dari a sampai b) [statis|dinamis [(chunk)]] [kurangi(op: x, ...)] { ... }
+    //
+    // runs the body for i = a .. b-1 on the thread pool. The body becomes
+    // a static worker over a range of i; variables from outside are copied
+    // into a context struct, so the body reads them but may not assign
+    // them (array elements are shared and may be). Reduction variables
+    // are the exception: each chunk works on its own copy, starting at the
+    // identity of op, and the copies are combined into x after the loop.
+    
+    struct Reduction {
+        std::string name;
+        int op;                 // 0 +, 1 *, 2 min, 3 maks (as in the runtime)
+        std::string identity;
+    };
+    
+    // 'kurangi(op: x, y)' (current token is 'kurangi')
+    void parseReductionClause(std::vector<Reduction>& reductions) {
+        static const std::vector<std::string> identities = {"0", "1", "INT_MAX", "INT_MIN"};
+        Token clause = current();
+        advance(); // skip 'kurangi'
+        expect(TokenType::LPAREN, "Expected '(' after 'kurangi'");
+        int op = -1;
+        if (match(TokenType::PLUS)) {
+            op = 0;
+        } else if (match(TokenType::STAR)) {
+            op = 1;
+        } else if (check(TokenType::IDENTIFIER) && (current().value == "min" || current().value == "maks")) {
+            op = current().value == "min" ? 2 : 3;
+            advance();
+        }
+        if (op < 0) {
+            std::cerr << "Error at line " << clause.line << ": kurangi expects +, *, min or maks" << std::endl;
+            std::exit(1);
+        }
+        expect(TokenType::COLON, "Expected ':' after the kurangi operator");
+        do {
+            Token var = current();
+            if (var.type != TokenType::IDENTIFIER || !varTypes.count(var.value) ||
+                varType(var.value) != ExprType::INT) {
+                std::cerr << "Error at line " << var.line << ": kurangi needs int variables declared before the loop"
+                          << std::endl;
+                std::exit(1);
+            }
+            for (const auto& r : reductions) {
+                if (r.name == var.value) {
+                    std::cerr << "Error at line " << var.line << ": '" << var.value << "' is reduced twice"
+                              << std::endl;
+                    std::exit(1);
+                }
+            }
+            reductions.push_back({var.value, op, identities[op]});
+            advance();
+        } while (match(TokenType::COMMA));
+        expect(TokenType::RPAREN, "Expected ')' after kurangi variables");
+    }
+    
+    // Outer variables the body tokens [start, end) use, in order of use
+    // (except 'locals': the index and reduction variables)
+    std::vector<std::string> capturedVariables(size_t start, size_t end, std::set<std::string> locals) {
+        for (size_t i = start; i + 1 < end; i++) {
+            if (tokens[i].type == TokenType::VAR) locals.insert(tokens[i + 1].value);
+        }
+        
+        std::vector<std::string> captured;
+        for (size_t i = start; i < end; i++) {
+            const Token& tok = tokens[i];
+            if (tok.type != TokenType::IDENTIFIER || locals.count(tok.value) || !varTypes.count(tok.value)) continue;
+            TokenType prev = tokens[i - 1].type;
+            bool statementStart = prev == TokenType::NEWLINE || prev == TokenType::LBRACE ||
+                                  prev == TokenType::RBRACE || prev == TokenType::SEMICOLON;
+            if ((statementStart && i + 1 < end && tokens[i + 1].type == TokenType::EQUAL) ||
+                isReceiveTarget(tokens, i)) {
+                std::cerr << "Error at line " << tok.line << ": paralel loop assigns '" << tok.value
+                          << "', which is shared by all iterations; declare it inside the loop"
+                          << " or store into an array element" << std::endl;
+                std::exit(1);
+            }
+            if (std::find(captured.begin(), captured.end(), tok.value) == captured.end()) {
+                captured.push_back(tok.value);
+            }
+        }
+        return captured;
+    }
+    
+    void generateParalel() {
+        advance(); // skip 'paralel'
+        expect(TokenType::LPAREN, "Expected '(' after 'paralel'");
+        if (!check(TokenType::IDENTIFIER)) {
+            expect(TokenType::IDENTIFIER, "Expected loop variable after 'paralel ('");
+        }
+        std::string index = current().value;
+        advance();
+        if (!check(TokenType::IDENTIFIER) || current().value != "dari") {
+            expect(TokenType::IDENTIFIER, "Expected 'dari' after the loop variable");
+        }
+        advance();
+        
+        // The lower bound ends at 'sampai'
+        size_t until = pos;
+        for (int depth = 0; until < tokens.size(); until++) {
+            TokenType t = tokens[until].type;
+            if (t == TokenType::LPAREN) depth++;
+            if (t == TokenType::RPAREN && --depth < 0) break;
+            if (t == TokenType::NEWLINE || t == TokenType::LBRACE || t == TokenType::END_OF_FILE) break;
+            if (depth == 0 && t == TokenType::IDENTIFIER && tokens[until].value == "sampai") break;
+        }
+        if (until >= tokens.size() || tokens[until].value != "sampai") {
+            std::cerr << "Error at line " << current().line << ": Expected 'sampai' in paralel range" << std::endl;
+            std::exit(1);
+        }
+        size_t prevEnd = expressionEnd;
+        expressionEnd = until;
+        auto from = generateTypedExpression();
+        expressionEnd = prevEnd;
+        advance(); // skip 'sampai'
+        auto to = generateTypedExpression();
+        expect(TokenType::RPAREN, "Expected ')' after paralel range");
+        
+        bool dynamic = false;
+        std::string chunk = "0";
+        std::vector<Reduction> reductions;
+        while (check(TokenType::IDENTIFIER)) {
+            if (current().value == "kurangi") {
+                parseReductionClause(reductions);
+            } else if (current().value == "statis" || current().value == "dinamis") {
+                dynamic = current().value == "dinamis";
+                advance();
+                if (match(TokenType::LPAREN)) {
+                    chunk = generateTypedExpression().code;
+                    expect(TokenType::RPAREN, "Expected ')' after chunk size");
+                }
+            } else {
+                break;
+            }
+        }
+        if (!check(TokenType::LBRACE)) {
+            expect(TokenType::LBRACE, "Expected '{' to start paralel body");
+        }
+        size_t bodyEnd = pos;
+        for (int depth = 0; bodyEnd < tokens.size(); bodyEnd++) {
+            if (tokens[bodyEnd].type == TokenType::LBRACE) depth++;
+            if (tokens[bodyEnd].type == TokenType::RBRACE && --depth == 0) break;
+        }
+        generateParalelLoop(index, from.code, to.code, chunk, dynamic, reductions, bodyEnd);
+        expect(TokenType::RBRACE, "Expected '}' to end paralel body");
+    }
+    
+    // Outline the statements after the '{' at pos, up to token 'stop', into
+    // a worker and run it for index = from .. to-1
+    void generateParalelLoop(const std::string& index, const std::string& from, const std::string& to,
+                             const std::string& chunk, bool dynamic, const std::vector<Reduction>& reductions,
+                             size_t stop) {
+        size_t bodyStart = pos;
+        std::set<std::string> locals = {index};
+        for (const auto& r : reductions) locals.insert(r.name);
+        std::vector<std::string> captured = capturedVariables(bodyStart + 1, stop, locals);
+        std::string worker = "__wear_paralel" + programNumber('w', ++workerCounter);
+        
+        std::ostringstream code;
+        code << "typedef struct {\n";
+        for (const auto& name : captured) code << "    " << cTypeName(varType(name)) << " " << name << ";\n";
+        for (const auto& r : reductions) code << "    __wear_slot* __r_" << r.name << ";\n";
+        if (captured.empty() && reductions.empty()) code << "    int unused;\n";
+        code << "} " << worker << "_ctx;\n\n";
+        code << "static void " << worker << "(void* __ctx, int __start, int __end) {\n";
+        code << "    " << worker << "_ctx* __c = (" << worker << "_ctx*)__ctx;\n";
+        for (const auto& name : captured) {
+            code << "    " << cTypeName(varType(name)) << " " << name << " = __c->" << name << ";\n";
+        }
+        for (const auto& r : reductions) code << "    int " << r.name << " = " << r.identity << ";\n";
+        code << "    (void)__c;\n";
+        code << "    for (int " << index << " = __start; " << index << " < __end; " << index << "++) {\n";
+        
+        // The body sees only its captured variables and the index
+        std::ostringstream body;
+        std::ostringstream* prevOutput = currentOutput;
+        int prevIndent = indentLevel;
+        std::unordered_map<std::string, ExprType> prevVarTypes = varTypes;
+        std::unordered_map<std::string, std::string> prevBuilders = builderVars;
+        bool prevInParalel = inParalel;
+        bool prevInGenerator = inGenerator;
+        currentOutput = &body;
+        indentLevel = 2;
+        varTypes.clear();
+        for (const auto& name : captured) varTypes[name] = prevVarTypes[name];
+        for (const auto& r : reductions) varTypes[r.name] = ExprType::INT;
+        varTypes[index] = ExprType::INT;
+        builderVars.clear();
+        inParalel = true;
+        inGenerator = false;
+        
+        expect(TokenType::LBRACE, "Expected '{' to start paralel body");
+        for (;;) {
+            while (check(TokenType::NEWLINE)) advance();
+            if (pos >= stop || check(TokenType::RBRACE) || check(TokenType::END_OF_FILE)) break;
+            generateStatement();
+        }
+        
+        currentOutput = prevOutput;
+        indentLevel = prevIndent;
+        varTypes = prevVarTypes;
+        builderVars = prevBuilders;
+        inParalel = prevInParalel;
+        inGenerator = prevInGenerator;
+        code << body.str() << "    }\n";
+        for (const auto& r : reductions) {
+            code << "    __wear_reduce_into(__c->__r_" << r.name << ", " << r.op << ", " << r.name << ");\n";
+        }
+        code << "}\n\n";
+        workersOutput << code.str();
+        usesParalel = true;
+        
+        // Call site: fill the context and run the loop
+        std::string context = "__p" + programNumber('w', workerCounter);
+        std::string fields;
+        for (const auto& name : captured) fields += (fields.empty() ? "" : ", ") + name;
+        emitLine("{");
+        indentLevel++;
+        for (const auto& r : reductions) {
+            std::string slots = context + "_" + r.name;
+            emitLine("__wear_slot* " + slots + " = __wear_reduce_slots(" + r.identity + ");");
+            fields += (fields.empty() ? "" : ", ") + slots;
+        }
+        emitLine(worker + "_ctx " + context + " = {" + (fields.empty() ? "0" : fields) + "};");
+        emitLine("__wear_paralel(" + from + ", " + to + ", " + chunk + ", " +
+                 (dynamic ? "1" : "0") + ", " + worker + ", &" + context + ");");
+        for (const auto& r : reductions) {
+            emitLine(r.name + " = __wear_reduce_finish(" + context + "_" + r.name + ", " +
+                     std::to_string(r.op) + ", " + r.name + ");");
+        }
+        indentLevel--;
+        emitLine("}");
+    }
+    
+    // ============================================================
+    // Automatic parallelization (--auto-paralel)
+    // ============================================================
+    //
+    // A counted loop
+    //
+    //   selama (i < n) { ... i = i + 1 }
+    //
+    // whose iterations are independent runs as a paralel loop when at
+    // least autoParalelMinTrips iterations are left. Independent means:
+    // - no cetak, file I/O, kembalikan, tasks, paralel or urutkan, and
+    //   calls only to pure functions and the int array builtins
+    // - outer variables are only read, except 'x = x + e' / 'x = x * e'
+    //   on an int x mentioned nowhere else (a kurangi reduction)
+    // - i only changes in the final increment, n not at all
+    // - array elements are only written at [i], and when any are, every
+    //   array access is at [i] (arrays may alias each other); an array
+    //   passed to an int array builtin is a read of all its elements
+    
+    struct CountedLoop {
+        std::string index;
+        bool inclusive = false;     // 'i <= n'
+        size_t boundStart = 0;      // Tokens of n
+        size_t boundEnd = 0;
+        size_t bodyStart = 0;       // '{'
+        size_t increment = 0;       // 'i = i + 1'
+        size_t end = 0;             // '}'
+        std::vector<Reduction> reductions;
+    };
+    
+    // Index of the token closing the bracket at 'open'
+    size_t matchingClose(size_t open) const {
+        TokenType left = tokens[open].type;
+        TokenType right = left == TokenType::LPAREN ? TokenType::RPAREN
+                        : left == TokenType::LBRACKET ? TokenType::RBRACKET : TokenType::RBRACE;
+        size_t k = open;
+        for (int depth = 0; k < tokens.size(); k++) {
+            if (tokens[k].type == left) depth++;
+            if (tokens[k].type == right && --depth == 0) break;
+        }
+        return k;
+    }
+    
+    // Whether 'x = x op e' (e from 'start' to the end of the statement)
+    // equals x op (e): no operator in e binds looser than op
+    bool isReductionOperand(size_t start, size_t end, TokenType op) const {
+        int depth = 0;
+        for (size_t k = start; k < end; k++) {
+            TokenType t = tokens[k].type;
+            if (t == TokenType::LPAREN || t == TokenType::LBRACKET) depth++;
+            if (t == TokenType::RPAREN || t == TokenType::RBRACKET) depth--;
+            if (depth > 0) continue;
+            switch (t) {
+                case TokenType::LESS: case TokenType::GREATER: case TokenType::LESS_EQUAL:
+                case TokenType::GREATER_EQUAL: case TokenType::EQUAL_EQUAL: case TokenType::NOT_EQUAL:
+                case TokenType::QUESTION: case TokenType::COLON:
+                    return false;
+                case TokenType::PLUS: case TokenType::MINUS: case TokenType::SLASH:
+                    if (op == TokenType::STAR) return false;
+                    break;
+                default:
+                    break;
+            }
+        }
+        return true;
+    }
+    
+    // Why the selama loop at loopStart must stay sequential, or "" when it
+    // can run in parallel (then 'loop' describes it)
+    std::string analyzeCountedLoop(size_t loopStart, CountedLoop& loop) {
+        const std::string notCounted = "the condition is not 'i < n' on an int variable";
+        size_t open = loopStart + 1;
+        if (open + 3 >= tokens.size() || tokens[open].type != TokenType::LPAREN ||
+            tokens[open + 1].type != TokenType::IDENTIFIER ||
+            (tokens[open + 2].type != TokenType::LESS && tokens[open + 2].type != TokenType::LESS_EQUAL)) {
+            return notCounted;
+        }
+        loop.index = tokens[open + 1].value;
+        if (!varTypes.count(loop.index) || varType(loop.index) != ExprType::INT) return notCounted;
+        loop.inclusive = tokens[open + 2].type == TokenType::LESS_EQUAL;
+        loop.boundStart = open + 3;
+        loop.boundEnd = matchingClose(open);
+        loop.bodyStart = loop.boundEnd + 1;
+        if (loop.bodyStart >= tokens.size() || tokens[loop.bodyStart].type != TokenType::LBRACE) return notCounted;
+        loop.end = matchingClose(loop.bodyStart);
+        
+        const std::string& i = loop.index;
+        size_t last = loop.end;
+        while (last > loop.bodyStart && tokens[last - 1].type == TokenType::NEWLINE) last--;
+        size_t inc = last - 5;
+        if (last < loop.bodyStart + 6 || tokens[inc].value != i || tokens[inc + 1].type != TokenType::EQUAL ||
+            tokens[inc + 2].value != i || tokens[inc + 3].type != TokenType::PLUS ||
+            tokens[inc + 4].type != TokenType::INTEGER || tokens[inc + 4].value != "1" ||
+            (tokens[inc - 1].type != TokenType::NEWLINE && tokens[inc - 1].type != TokenType::LBRACE)) {
+            return "the body does not end with '" + i + " = " + i + " + 1'";
+        }
+        loop.increment = inc;
+        
+        struct ArrayAccess {
+            std::string name;
+            bool write;
+            bool atIndex;
+            bool whole = false;         // Passed to an int array builtin
+        };
+        std::set<std::string> locals;
+        std::map<std::string, int> mentions;
+        std::vector<size_t> writes;             // 'x = ...' on outer variables
+        std::vector<ArrayAccess> accesses;
+        for (size_t k = loop.bodyStart + 1; k < inc; k++) {
+            const Token& t = tokens[k];
+            switch (t.type) {
+                case TokenType::CETAK: return "it prints (cetak)";
+                case TokenType::BACA_FILE: case TokenType::TULIS_FILE: return "it does file I/O";
+                case TokenType::KEMBALIKAN: return "it returns from inside the loop";
+                case TokenType::JALANKAN: case TokenType::TUNGGU: return "it starts or waits for tasks";
+                case TokenType::PARALEL: return "it contains a paralel loop";
+                case TokenType::URUTKAN: return "it sorts an array in place";
+                case TokenType::HASILKAN: return "it yields (hasilkan)";
+                default: break;
+            }
+            if (t.type == TokenType::VAR && tokens[k + 1].type == TokenType::IDENTIFIER) {
+                locals.insert(tokens[k + 1].value);
+                k++;
+                continue;
+            }
+            if (t.type != TokenType::IDENTIFIER) continue;
+            mentions[t.value]++;
+            
+            TokenType next = tokens[k + 1].type;
+            if (next == TokenType::LPAREN) {
+                bool pure = functions.count(t.value) ? pureFunctions.count(t.value) > 0 : isIntArrayBuiltin(t.value);
+                if (!pure) return "it calls " + t.value + ", which may have side effects";
+                if (functions.count(t.value)) continue;   // Pure functions do not touch arrays
+                
+                // Builtins read every element of the arrays passed to them
+                size_t close = matchingClose(k + 1);
+                for (size_t a = k + 2; a < close; a++) {
+                    const Token& arg = tokens[a];
+                    bool bare = arg.type == TokenType::IDENTIFIER &&
+                                (tokens[a - 1].type == TokenType::LPAREN || tokens[a - 1].type == TokenType::COMMA) &&
+                                (tokens[a + 1].type == TokenType::COMMA || tokens[a + 1].type == TokenType::RPAREN);
+                    bool scalar = varTypes.count(arg.value) && !isArrayType(varType(arg.value));
+                    if (bare && !scalar) accesses.push_back({arg.value, false, false, true});
+                }
+                continue;
+            }
+            TokenType prev = tokens[k - 1].type;
+            bool statementStart = prev == TokenType::NEWLINE || prev == TokenType::LBRACE ||
+                                  prev == TokenType::RBRACE || prev == TokenType::SEMICOLON;
+            if (next == TokenType::LBRACKET) {
+                size_t close = matchingClose(k + 1);
+                if (statementStart && close + 1 < inc && tokens[close + 1].type == TokenType::LBRACKET) {
+                    return "it writes an element of a nested array";
+                }
+                bool atIndex = close == k + 3 && tokens[k + 2].value == i;
+                bool write = statementStart && close + 1 < inc && tokens[close + 1].type == TokenType::EQUAL;
+                accesses.push_back({t.value, write, atIndex});
+            } else if (statementStart && next == TokenType::EQUAL) {
+                if (t.value == i) return "it assigns " + i + " before the final increment";
+                if (!locals.count(t.value)) writes.push_back(k);
+            }
+        }
+        
+        // Outer scalars: only reductions
+        std::map<std::string, int> writeCounts;
+        for (size_t k : writes) writeCounts[tokens[k].value]++;
+        for (size_t k : writes) {
+            const std::string& name = tokens[k].value;
+            const std::string carried = "it assigns '" + name + "', which carries over to the next iteration";
+            TokenType op = tokens[k + 3].type;
+            if (varType(name) != ExprType::INT || tokens[k + 2].value != name ||
+                (op != TokenType::PLUS && op != TokenType::STAR) || mentions[name] != 2 * writeCounts[name]) {
+                return carried;
+            }
+            size_t end = k + 4;
+            while (end < inc && tokens[end].type != TokenType::NEWLINE && tokens[end].type != TokenType::SEMICOLON &&
+                   tokens[end].type != TokenType::RBRACE) {
+                end++;
+            }
+            if (!isReductionOperand(k + 4, end, op)) return carried;
+            int code = op == TokenType::PLUS ? 0 : 1;
+            bool seen = false;
+            for (const auto& r : loop.reductions) {
+                if (r.name != name) continue;
+                if (r.op != code) return carried;
+                seen = true;
+            }
+            if (!seen) loop.reductions.push_back({name, code, code == 0 ? "0" : "1"});
+        }
+        
+        // Arrays: iteration i only writes element i
+        bool writesArrays = false;
+        for (const auto& access : accesses) {
+            if (access.write && !access.atIndex) {
+                return "it writes " + access.name + "[...] at another index than " + i;
+            }
+            writesArrays = writesArrays || access.write;
+        }
+        for (const auto& access : accesses) {
+            if (writesArrays && access.whole) {
+                return "it passes " + access.name + " to an array builtin while writing array elements";
+            }
+            if (writesArrays && !access.atIndex) {
+                return "it reads " + access.name + "[...] at another index than " + i +
+                       " while writing array elements";
+            }
+        }
+        
+        // The bound must not change while the loop runs
+        for (size_t k = loop.boundStart; k < loop.boundEnd; k++) {
+            const Token& t = tokens[k];
+            if (t.type == TokenType::IDENTIFIER && tokens[k + 1].type == TokenType::LPAREN) {
+                return "the bound " + t.value + "(...) is a call";
+            }
+            if (t.type == TokenType::IDENTIFIER && (t.value == i || writeCounts.count(t.value))) {
+                return "the bound changes inside the loop";
+            }
+        }
+        return "";
+    }
+    
+    // The loop as 'if (enough iterations) paralel else selama'. 'i' ends
+    // where the sequential loop would leave it
+    void generateAutoParalel(size_t loopStart, const CountedLoop& loop) {
+        pos = loop.boundStart;
+        size_t prevEnd = expressionEnd;
+        expressionEnd = loop.boundEnd;
+        std::string bound = generateTypedExpression().code;
+        expressionEnd = prevEnd;
+        std::string to = loop.inclusive ? "(" + bound + ") + 1" : bound;
+        
+        emitLine("if ((long long)(" + to + ") - " + loop.index + " >= " + std::to_string(autoParalelMinTrips) + ") {");
+        indentLevel++;
+        pos = loop.bodyStart;
+        generateParalelLoop(loop.index, loop.index, to, "0", false, loop.reductions, loop.increment);
+        emitLine(loop.index + " = " + to + ";");
+        indentLevel--;
+        emitLine("} else {");
+        indentLevel++;
+        pos = loopStart;
+        generateWhile(false);
+        indentLevel--;
+        emitLine("}");
+    }
+    
+    // ============================================================
+    // Generators (hasilkan / untuk)
+    // ============================================================
+    //
+    // A function whose body uses 'hasilkan x' is a generator. It is only
+    // called from 'untuk (x dari f(a)) { ... }', which runs the loop body
+    // for each value f yields. Each generator clone F becomes
+    //
+    //   struct __wear_F_gen   state, the last value, parameters, locals
+    //                         and the generators its own untuk loops iterate
+    //   __wear_F_start(g, a)  set up g for the call f(a)
+    //   __wear_F_next(g)      run to the next hasilkan: 1 with g->__value
+    //                         set, 0 once the body has finished
+    //
+    // __wear_F_next switches on the state to jump back to the statement
+    // after the hasilkan it left from. Locals are loaded from the struct on
+    // entry and stored back before each hasilkan, so the body is generated
+    // as usual except that 'var' assigns the variable declared on entry.
+    // Structs nest by value: iterating a chain of generators allocates
+    // nothing.
+    
+    bool isGenerator(const std::string& name) const {
+        auto it = functions.find(name);
+        return it != functions.end() && it->second.generator;
+    }
+    
+    // A variable of the current generator; every name keeps one type
+    void declareGeneratorLocal(const std::string& name, ExprType type, int line) {
+        for (const auto& local : generatorLocals) {
+            if (local.first != name) continue;
+            if (local.second != type) {
+                std::cerr << "Error at line " << line << ": '" << name << "' holds values of two types in generator '"
+                          << currentFunction << "'" << std::endl;
+                std::exit(1);
+            }
+            return;
+        }
+        generatorLocals.push_back({name, type});
+    }
+    
+    // 'hasilkan x': hand x to the untuk loop; resume after this statement
+    void generateYield() {
+        Token keyword = current();
+        if (!inGenerator || inParalel) {
+            std::cerr << "Error at line " << keyword.line << ": hasilkan "
+                      << (inParalel ? "cannot leave a paralel loop" : "is only allowed in a function body")
+                      << std::endl;
+            std::exit(1);
+        }
+        advance(); // skip 'hasilkan'
+        auto expr = generateTypedExpression();
+        noteReturnType(expr.type);
+        std::string state = std::to_string(++yieldCounter);
+        emitLine("__g->__value = " + coerce(expr, currentKnownReturn) + ";");
+        emitLine("__g->__state = " + state + ";");
+        emitLine(generatorSaveMarker);
+        emitLine("return 1;");
+        emitLine("case " + state + ":;");
+    }
+    
+    // 'untuk (x dari f(a)) { ... }'
+    void generateForEach() {
+        Token keyword = current();
+        advance(); // skip 'untuk'
+        expect(TokenType::LPAREN, "Expected '(' after 'untuk'");
+        if (!check(TokenType::IDENTIFIER)) expect(TokenType::IDENTIFIER, "Expected loop variable after 'untuk ('");
+        std::string var = current().value;
+        advance();
+        if (!check(TokenType::IDENTIFIER) || current().value != "dari") {
+            std::cerr << "Error at line " << current().line << ", column " << current().column
+                      << ": Expected 'dari' after the loop variable" << std::endl;
+            std::exit(1);
+        }
+        advance();
+        if (!check(TokenType::IDENTIFIER) || peek().type != TokenType::LPAREN || !isGenerator(current().value)) {
+            std::cerr << "Error at line " << keyword.line
+                      << ": untuk iterates a call of a generator (a function with hasilkan)" << std::endl;
+            std::exit(1);
+        }
+        std::string name = current().value;
+        advance();
+        std::string callee;
+        std::vector<ExprResult> args;
+        ExprType type = generateCallArguments(name, callee, args);
+        if (type == ExprType::UNKNOWN) type = ExprType::INT;
+        expect(TokenType::RPAREN, "Expected ')' after the generator call");
+        
+        std::string arguments;
+        for (const auto& arg : args) arguments += ", " + arg.code;
+        std::string iterator = "__it" + std::to_string(++iteratorCounter);
+        bool nested = inGenerator && !inParalel;
+        std::string ref = nested ? "__g->" + iterator : iterator;
+        if (nested) {
+            generatorIterators.push_back({iterator, callee});
+        } else {
+            emitLine("{");
+            indentLevel++;
+            emitLine("__wear_" + callee + "_gen " + iterator + ";");
+        }
+        emitLine("__wear_" + callee + "_start(&" + ref + arguments + ");");
+        emitLine("while (__wear_" + callee + "_next(&" + ref + ")) {");
+        indentLevel++;
+        auto previous = varTypes.find(var);
+        std::pair<bool, ExprType> shadowed = {previous != varTypes.end(), ExprType::UNKNOWN};
+        if (shadowed.first) shadowed.second = previous->second;
+        if (nested) {
+            declareGeneratorLocal(var, type, keyword.line);
+            emitLine(var + " = " + ref + ".__value;");
+        } else {
+            emitLine(cTypeName(type) + " " + var + " = " + ref + ".__value;");
+        }
+        varTypes[var] = type;
+        
+        expect(TokenType::LBRACE, "Expected '{' to start untuk body");
+        while (!check(TokenType::RBRACE) && !check(TokenType::END_OF_FILE)) {
+            generateStatement();
+        }
+        expect(TokenType::RBRACE, "Expected '}' to end untuk body");
+        indentLevel--;
+        emitLine("}");
+        if (!nested) {
+            indentLevel--;
+            emitLine("}");
+            if (shadowed.first) {
+                varTypes[var] = shadowed.second;
+            } else {
+                varTypes.erase(var);
+            }
+        }
+    }
+    
+    // Struct and functions of a generator clone from its generated body
+    void finishGenerator(const FunctionInfo& info, Specialization& spec, const std::string& body) {
+        std::string gen = "__wear_" + spec.cName + "_gen";
+        std::string params;
+        for (size_t i = 0; i < info.params.size(); i++) {
+            params += ", " + cTypeName(spec.paramTypes[i]) + " " + info.params[i];
+        }
+        
+        std::ostringstream header;
+        header << "struct " << gen << " {\n";
+        header << "    int __state;\n";
+        header << "    " << cTypeName(spec.returnType) << " __value;\n";
+        for (const auto& local : generatorLocals) {
+            header << "    " << cTypeName(local.second) << " " << local.first << ";\n";
+        }
+        spec.iterates.clear();
+        for (const auto& iterator : generatorIterators) {
+            header << "    __wear_" << iterator.second << "_gen " << iterator.first << ";\n";
+            spec.iterates.push_back(iterator.second);
+        }
+        header << "};\n";
+        spec.header = header.str();
+        
+        std::string save;
+        for (const auto& local : generatorLocals) {
+            save += (save.empty() ? "" : " ") + std::string("__g->") + local.first + " = " + local.first + ";";
+        }
+        std::ostringstream code;
+        code << "void __wear_" << spec.cName << "_start(" << gen << "* __g" << params << ") {\n";
+        code << "    memset(__g, 0, sizeof(*__g));\n";
+        for (const auto& param : info.params) code << "    __g->" << param << " = " << param << ";\n";
+        code << "}\n\n";
+        code << "int __wear_" << spec.cName << "_next(" << gen << "* __g) {\n";
+        for (const auto& local : generatorLocals) {
+            code << "    " << cTypeName(local.second) << " " << local.first << " = __g->" << local.first << ";\n";
+        }
+        code << "    switch (__g->__state) {\n";
+        code << "    case 0:;\n";
+        std::istringstream lines(body);
+        std::string line;
+        while (std::getline(lines, line)) {
+            size_t marker = line.find(generatorSaveMarker);
+            if (marker == std::string::npos) {
+                code << line << "\n";
+            } else if (!save.empty()) {
+                code << line.substr(0, marker) << save << "\n";
+            }
+        }
+        code << "    }\n";
+        code << "    __g->__state = -1;\n";
+        code << "    return 0;\n";
+        code << "}\n\n";
+        spec.code = code.str();
+    }
+    
+    // Generator structs, each after those it contains, and the prototypes
+    // of their functions
+    std::string generatorDeclarations() {
+        std::map<std::string, const Specialization*> byName;
+        std::vector<std::pair<const FunctionInfo*, const Specialization*>> order;
+        for (const auto& name : functionOrder) {
+            if (!functions[name].generator) continue;
+            for (const auto& spec : specializations[name]) {
+                byName[spec.cName] = &spec;
+                order.push_back({&functions[name], &spec});
+            }
+        }
+        if (order.empty()) return "";
+        
+        std::ostringstream out;
+        std::map<std::string, int> state;   // 1 being emitted, 2 done
+        for (const auto& entry : order) {
+            const std::string& c = entry.second->cName;
+            out << "typedef struct __wear_" << c << "_gen __wear_" << c << "_gen;\n";
+        }
+        out << "\n";
+        for (const auto& entry : order) emitGeneratorStruct(*entry.second, byName, state, out);
+        for (const auto& entry : order) {
+            const FunctionInfo& info = *entry.first;
+            const Specialization& spec = *entry.second;
+            std::string gen = "__wear_" + spec.cName + "_gen";
+            out << "void __wear_" << spec.cName << "_start(" << gen << "* __g";
+            for (size_t i = 0; i < info.params.size(); i++) {
+                out << ", " << cTypeName(spec.paramTypes[i]) << " " << info.params[i];
+            }
+            out << ");\n";
+            out << "int __wear_" << spec.cName << "_next(" << gen << "* __g);\n";
+        }
+        return out.str();
+    }
+    
+    // The struct of a generator after the structs of the generators it
+    // iterates (a C struct must be complete before it can be a field)
+    static void emitGeneratorStruct(const Specialization& spec,
+                                    const std::map<std::string, const Specialization*>& byName,
+                                    std::map<std::string, int>& state, std::ostringstream& out) {
+        if (state[spec.cName] == 2) return;
+        if (state[spec.cName] == 1) {
+            std::cerr << "Error: Generator '" << spec.cName << "' iterates itself; generators cannot recurse"
+                      << std::endl;
+            std::exit(1);
+        }
+        state[spec.cName] = 1;
+        for (const auto& inner : spec.iterates) {
+            auto it = byName.find(inner);
+            if (it != byName.end()) emitGeneratorStruct(*it->second, byName, state, out);
+        }
+        out << spec.header << "\n";
+        state[spec.cName] = 2;
+    }
+    
+    // Generate if statement
+    void generateIf() {
+        advance(); // skip 'jika'
+        
+        expect(TokenType::LPAREN, "Expected '(' after 'jika'");
+        std::string condition = generateExpression();
+        expect(TokenType::RPAREN, "Expected ')' after condition");
+        
+        emitLine("if (" + condition + ") {");
+        
+        expect(TokenType::LBRACE, "Expected '{' to start if body");
+        indentLevel++;
+        
+        while (!check(TokenType::RBRACE) && !check(TokenType::END_OF_FILE)) {
+            generateStatement();
+        }
+        
+        indentLevel--;
+        expect(TokenType::RBRACE, "Expected '}' to end if body");
+        emitLine("}");
+        
+        // Handle else
+        if (check(TokenType::LAINNYA)) {
+            advance();
+            if (check(TokenType::JIKA)) {
+                *currentOutput << indent() << "else ";
+                generateIf();
+            } else {
+                emitLine("else {");
+                expect(TokenType::LBRACE, "Expected '{' after 'lainnya'");
+                indentLevel++;
+                
+                while (!check(TokenType::RBRACE) && !check(TokenType::END_OF_FILE)) {
+                    generateStatement();
+                }
+                
+                indentLevel--;
+                expect(TokenType::RBRACE, "Expected '}' to end else body");
+                emitLine("}");
+            }
+        }
+    }
+    
+    // Parse a type annotation name (int / teks)
+    ExprType parseTypeName() {
+        Token tok = current();
+        if (tok.type == TokenType::IDENTIFIER) {
+            if (tok.value == "int") {
+                advance();
+                return ExprType::INT;
+            }
+            if (tok.value == "teks" || tok.value == "str") {
+                advance();
+                return ExprType::STRING;
+            }
+        }
+        std::cerr << "Error at line " << tok.line
+                  << ", column " << tok.column
+                  << ": Unknown type '" << tok.value << "' (expected 'int' or 'teks')" << std::endl;
+        std::exit(1);
+    }
+    
+    // Parse 'fungsi name(p: type, ...): type' and locate the body
+    FunctionInfo parseFunctionHeader() {
+        FunctionInfo info;
+        advance(); // skip 'fungsi'
+        
+        if (!check(TokenType::IDENTIFIER)) {
+            expect(TokenType::IDENTIFIER, "Expected function name after 'fungsi'");
+        }
+        info.name = current().value;
+        advance(); // skip function name
+        
+        expect(TokenType::LPAREN, "Expected '(' after function name");
+        
+        // Parse parameters with optional type annotations
+        while (!check(TokenType::RPAREN) && !check(TokenType::END_OF_FILE)) {
+            if (!info.params.empty()) {
+                expect(TokenType::COMMA, "Expected ',' between parameters");
+            }
+            
+            if (!check(TokenType::IDENTIFIER)) {
+                expect(TokenType::IDENTIFIER, "Expected parameter name");
+            }
+            info.params.push_back(current().value);
+            advance();
+            
+            ExprType type = ExprType::UNKNOWN;
+            if (match(TokenType::COLON)) {
+                type = parseTypeName();
+            }
+            info.paramTypes.push_back(type);
+        }
+        
+        expect(TokenType::RPAREN, "Expected ')' after parameters");
+        
+        // Optional return type
+        if (match(TokenType::COLON)) {
+            info.returnType = parseTypeName();
+        }
+        
+        if (!check(TokenType::LBRACE)) {
+            expect(TokenType::LBRACE, "Expected '{' to start function body");
+        }
+        info.bodyStart = pos;
+        
+        // Find the matching closing brace
+        int depth = 0;
+        while (!check(TokenType::END_OF_FILE)) {
+            if (check(TokenType::LBRACE)) depth++;
+            if (check(TokenType::RBRACE)) depth--;
+            advance();
+            if (depth == 0) break;
+        }
+        info.end = pos;
+        
+        return info;
+    }
+    
+    // Parse '@name' or '@name(arg)'
+    std::pair<std::string, std::string> parseAnnotation() {
+        std::string name = current().value;
+        advance();
+        std::string arg;
+        if (match(TokenType::LPAREN)) {
+            arg = current().value;
+            advance();
+            expect(TokenType::RPAREN, "Expected ')' after annotation argument");
+        }
+        if (name != "sisip" && name != "ingat") {
+            std::cerr << "Warning: Unknown annotation '@" << name << "' ignored" << std::endl;
+        }
+        return {name, arg};
     }
     
-    std::vector<Token> tokenize() {
-        std::vector<Token> tokens;
+    // Collect every function signature up front so calls can be typed
+    // regardless of declaration order
+    void indexFunctions() {
+        size_t savedPos = pos;
+        pos = 0;
+        functions.clear();
+        functionOrder.clear();
+        declaredFunctions.clear();
+        std::map<std::string, std::string> pendingAnnotations;
         
-        while (pos < source.length()) {
-            skipWhitespace();
-            
-            if (current() == '\0') break;
-            
-            int startLine = line;
-            int startCol = column;
-            
-            // Newlines (statement terminators)
-            if (current() == '\n') {
-                tokens.push_back(Token(TokenType::NEWLINE, "\\n", startLine, startCol));
+        while (!check(TokenType::END_OF_FILE)) {
+            if (check(TokenType::ANNOTATION)) {
+                pendingAnnotations.insert(parseAnnotation());
+            } else if (check(TokenType::FUNGSI)) {
+                FunctionInfo info = parseFunctionHeader();
+                info.annotations = pendingAnnotations;
+                pendingAnnotations.clear();
+                if (functions.count(info.name)) {
+                    std::cerr << "Error: Function '" << info.name << "' is declared twice" << std::endl;
+                    std::exit(1);
+                }
+                for (size_t i = info.bodyStart; i < info.end; i++) {
+                    if (tokens[i].type == TokenType::HASILKAN) info.generator = true;
+                }
+                declaredFunctions.insert(info.name);
+                functionOrder.push_back(info.name);
+                functions[info.name] = info;
+            } else {
                 advance();
-                continue;
             }
+        }
+        
+        // Hints may refer to annotations of functions declared later
+        for (const auto& name : functionOrder) {
+            computeParamHints(functions[name]);
+        }
+        
+        pos = savedPos;
+    }
+    
+    // Suggest a type for each unannotated parameter from how the body uses
+    // it: operands of arithmetic/ordering are int, string builtin arguments
+    // are teks, arguments of annotated parameters take that annotation
+    void computeParamHints(FunctionInfo& info) const {
+        info.paramHints.assign(info.params.size(), ExprType::UNKNOWN);
+        
+        for (size_t i = info.bodyStart + 1; i + 1 < info.end; i++) {
+            if (tokens[i].type != TokenType::IDENTIFIER) continue;
             
-            // Comments
-            if (current() == '/' && peek() == '/') {
-                skipLineComment();
-                continue;
-            }
+            size_t k = 0;
+            while (k < info.params.size() && info.params[k] != tokens[i].value) k++;
+            if (k == info.params.size() || info.paramHints[k] != ExprType::UNKNOWN) continue;
             
-            // String literals
-            if (current() == '"') {
-                tokens.push_back(scanString());
+            TokenType prev = tokens[i - 1].type;
+            TokenType next = tokens[i + 1].type;
+            if (isNumericOperator(prev) || isNumericOperator(next) ||
+                ((prev == TokenType::EQUAL_EQUAL || prev == TokenType::NOT_EQUAL) && tokens[i - 2].type == TokenType::INTEGER) ||
+                ((next == TokenType::EQUAL_EQUAL || next == TokenType::NOT_EQUAL) && tokens[i + 2].type == TokenType::INTEGER)) {
+                info.paramHints[k] = ExprType::INT;
                 continue;
             }
             
-            // Numbers
-            if (std::isdigit(current())) {
-                tokens.push_back(scanNumber());
+            // Direct argument of a call: find the call head and argument index
+            if ((prev != TokenType::LPAREN && prev != TokenType::COMMA) ||
+                (next != TokenType::RPAREN && next != TokenType::COMMA)) {
                 continue;
             }
-            
-            // Identifiers and keywords
-            if (std::isalpha(current()) || current() == '_') {
-                tokens.push_back(scanIdentifier());
-                continue;
+            int depth = 0;
+            size_t argIndex = 0;
+            size_t j = i;
+            while (j > info.bodyStart) {
+                j--;
+                TokenType t = tokens[j].type;
+                if (t == TokenType::RPAREN) depth++;
+                else if (t == TokenType::LPAREN) {
+                    if (depth == 0) break;
+                    depth--;
+                } else if (t == TokenType::COMMA && depth == 0) argIndex++;
             }
+            if (j == info.bodyStart) continue;
             
-            // Operators and delimiters
-            switch (current()) {
-                case '+':
-                    tokens.push_back(Token(TokenType::PLUS, "+", startLine, startCol));
-                    advance();
-                    break;
-                case '-':
-                    tokens.push_back(Token(TokenType::MINUS, "-", startLine, startCol));
-                    advance();
-                    break;
-                case '*':
-                    tokens.push_back(Token(TokenType::STAR, "*", startLine, startCol));
-                    advance();
-                    break;
-                case '/':
-                    tokens.push_back(Token(TokenType::SLASH, "/", startLine, startCol));
-                    advance();
+            const Token& head = tokens[j - 1];
+            switch (head.type) {
+                case TokenType::SAMA:
+                case TokenType::PANJANG:
+                case TokenType::IS_QUOTE:
+                case TokenType::IS_NEWLINE:
+                case TokenType::BACA_FILE:
+                case TokenType::TULIS_FILE:
+                    info.paramHints[k] = ExprType::STRING;
                     break;
-                case '=':
-                    advance();
-                    if (current() == '=') {
-                        tokens.push_back(Token(TokenType::EQUAL_EQUAL, "==", startLine, startCol));
-                        advance();
-                    } else {
-                        tokens.push_back(Token(TokenType::EQUAL, "=", startLine, startCol));
-                    }
+                case TokenType::CHAR_AT:
+                case TokenType::KODE_AT:
+                case TokenType::POTONG:
+                case TokenType::COCOK:
+                    info.paramHints[k] = argIndex == 0 ? ExprType::STRING : ExprType::INT;
                     break;
-                case '<':
-                    advance();
-                    if (current() == '=') {
-                        tokens.push_back(Token(TokenType::LESS_EQUAL, "<=", startLine, startCol));
-                        advance();
-                    } else {
-                        tokens.push_back(Token(TokenType::LESS, "<", startLine, startCol));
-                    }
+                case TokenType::PISAH:
+                    info.paramHints[k] = ExprType::STRING;
                     break;
-                case '>':
-                    advance();
-                    if (current() == '=') {
-                        tokens.push_back(Token(TokenType::GREATER_EQUAL, ">=", startLine, startCol));
-                        advance();
-                    } else {
-                        tokens.push_back(Token(TokenType::GREATER, ">", startLine, startCol));
-                    }
+                case TokenType::IS_DIGIT_KODE:
+                case TokenType::IS_LETTER_KODE:
+                    info.paramHints[k] = ExprType::INT;
                     break;
-                case '!':
-                    advance();
-                    if (current() == '=') {
-                        tokens.push_back(Token(TokenType::NOT_EQUAL, "!=", startLine, startCol));
-                        advance();
-                    } else {
-                        tokens.push_back(Token(TokenType::UNKNOWN, "!", startLine, startCol));
+                case TokenType::IDENTIFIER: {
+                    auto callee = functions.find(head.value);
+                    if (callee != functions.end() && argIndex < callee->second.paramTypes.size()) {
+                        info.paramHints[k] = callee->second.paramTypes[argIndex];
                     }
                     break;
-                case '(':
-                    tokens.push_back(Token(TokenType::LPAREN, "(", startLine, startCol));
-                    advance();
-                    break;
-                case ')':
-                    tokens.push_back(Token(TokenType::RPAREN, ")", startLine, startCol));
-                    advance();
-                    break;
-                case '{':
-                    tokens.push_back(Token(TokenType::LBRACE, "{", startLine, startCol));
-                    advance();
-                    break;
-                case '}':
-                    tokens.push_back(Token(TokenType::RBRACE, "}", startLine, startCol));
-                    advance();
-                    break;
-                case '[':
-                    tokens.push_back(Token(TokenType::LBRACKET, "[", startLine, startCol));
-                    advance();
-                    break;
-                case ']':
-                    tokens.push_back(Token(TokenType::RBRACKET, "]", startLine, startCol));
-                    advance();
-                    break;
-                case ';':
-                    tokens.push_back(Token(TokenType::SEMICOLON, ";", startLine, startCol));
-                    advance();
-                    break;
-                case ',':
-                    tokens.push_back(Token(TokenType::COMMA, ",", startLine, startCol));
-                    advance();
-                    break;
+                }
                 default:
-                    tokens.push_back(Token(TokenType::UNKNOWN, std::string(1, current()), startLine, startCol));
-                    advance();
                     break;
             }
         }
+    }
+    
+    static bool isNumericOperator(TokenType type) {
+        return type == TokenType::MINUS || type == TokenType::STAR || type == TokenType::SLASH ||
+               type == TokenType::LESS || type == TokenType::GREATER ||
+               type == TokenType::LESS_EQUAL || type == TokenType::GREATER_EQUAL;
+    }
+    
+    // Parameter type of a clone: annotation, then argument type at the
+    // call site, then usage hint; unconstrained parameters stay char*
+    ExprType resolveParamType(const FunctionInfo& info, size_t i, ExprType argType) const {
+        if (info.paramTypes[i] != ExprType::UNKNOWN) return info.paramTypes[i];
+        if (argType != ExprType::UNKNOWN) return argType;
+        if (info.paramHints[i] != ExprType::UNKNOWN) return info.paramHints[i];
+        return ExprType::STRING;
+    }
+    
+    // Find or create the clone of a function for the given parameter types
+    Specialization requestSpecialization(const FunctionInfo& info, const std::vector<ExprType>& types) {
+        if (isWorker) {
+            // The parent finds or queues it when it takes the caller over
+            requestedClones.push_back({info.name, types});
+            return newSpecialization(info, types);
+        }
+        auto& specs = specializations[info.name];
+        for (const auto& spec : specs) {
+            if (spec.paramTypes == types) return spec;
+        }
+        
+        Specialization spec = newSpecialization(info, types);
+        specs.push_back(spec);
+        specQueue.push_back({info.name, specs.size() - 1});
+        return spec;
+    }
+    
+    // A clone's name and return type follow from the previous pass alone
+    Specialization newSpecialization(const FunctionInfo& info, const std::vector<ExprType>& types) const {
+        Specialization spec;
+        spec.paramTypes = types;
+        auto known = knownReturns.find(info.name + "(" + typeKey(types) + ")");
+        if (info.returnType != ExprType::UNKNOWN) {
+            spec.returnType = info.returnType;
+        } else if (known != knownReturns.end()) {
+            spec.returnType = known->second;
+        }
+        // Only mangle when the previous pass saw several clones
+        auto count = knownSpecCounts.find(info.name);
+        bool cloned = count != knownSpecCounts.end() && count->second > 1;
+        spec.cName = cloned ? info.name + "__" + typeKey(types) : info.name;
+        return spec;
+    }
+    
+    // Generate a call 'name(args)' (current token is '('); WeaR functions
+    // resolve to the clone matching the argument types
+    ExprResult generateCall(const std::string& name) {
+        if (isIntArrayBuiltin(name)) return generateIntArrayBuiltin(name);
+        if (isChannelBuiltin(name)) return generateChannelBuiltin(name);
+        if (isAtomicBuiltin(name)) return generateAtomicBuiltin(name);
+        if (name == "baca_banyak" && functions.find(name) == functions.end()) return generateReadMany();
+        if (isGenerator(name)) {
+            std::cerr << "Error at line " << current().line << ": Generator '" << name
+                      << "' is iterated with 'untuk (x dari " << name << "(...))', not called" << std::endl;
+            std::exit(1);
+        }
+        std::string callee;
+        std::vector<ExprResult> args;
+        ExprType type = generateCallArguments(name, callee, args);
+        
+        std::ostringstream call;
+        call << callee << "(";
+        for (size_t i = 0; i < args.size(); i++) {
+            if (i > 0) call << ", ";
+            call << args[i].code;
+        }
+        call << ")";
+        return ExprResult(call.str(), type);
+    }
+    
+    // The arguments of a call (from '('), each converted to the type the
+    // callee takes. Sets the C function to call; returns its return type
+    ExprType generateCallArguments(const std::string& name, std::string& callee, std::vector<ExprResult>& converted) {
+        expect(TokenType::LPAREN, "Expected '('");
+        
+        std::vector<ExprResult> args;
+        while (!check(TokenType::RPAREN) && !check(TokenType::END_OF_FILE)) {
+            if (!args.empty()) {
+                expect(TokenType::COMMA, "Expected ','");
+            }
+            args.push_back(generateTypedExpression());
+        }
+        expect(TokenType::RPAREN, "Expected ')'");
+        
+        callee = name;
+        ExprType type = ExprType::INT;  // Not a WeaR function (e.g. a C function)
+        auto fn = functions.find(name);
+        if (fn != functions.end()) {
+            const FunctionInfo& info = fn->second;
+            if (args.size() != info.params.size()) {
+                std::cerr << "Error at line " << current().line
+                          << ": Function '" << name << "' expects " << info.params.size()
+                          << " argument(s), got " << args.size() << std::endl;
+                std::exit(1);
+            }
+            std::vector<ExprType> types;
+            for (size_t i = 0; i < args.size(); i++) {
+                types.push_back(resolveParamType(info, i, args[i].type));
+            }
+            Specialization spec = requestSpecialization(info, types);
+            callee = spec.cName;
+            type = spec.returnType;
+        }
         
-        tokens.push_back(Token(TokenType::END_OF_FILE, "", line, column));
-        return tokens;
+        for (size_t i = 0; i < args.size(); i++) {
+            if (fn != functions.end()) {
+                ExprType target = resolveParamType(fn->second, i, args[i].type);
+                converted.push_back(ExprResult(coerce(args[i], target), target));
+            } else {
+                ExprType target = args[i].type == ExprType::VIEW ? ExprType::STRING : args[i].type;
+                converted.push_back(ExprResult(asCString(args[i]), target));
+            }
+        }
+        return type;
     }
-};
-
-// ============================================================
-// Expression Type (for type inference)
-// ============================================================
-
-enum class ExprType {
-    INT,
-    STRING,
-    UNKNOWN
-};
-
-// Expression result with type info
-struct ExprResult {
-    std::string code;
-    ExprType type;
     
-    ExprResult(const std::string& c, ExprType t) : code(c), type(t) {}
-    ExprResult() : code(""), type(ExprType::UNKNOWN) {}
-};
-
-// ============================================================
-// Code Generator (Transpiler to C)
-// ============================================================
-
-class CodeGenerator {
-private:
-    std::vector<Token> tokens;
-    size_t pos = 0;
-    std::ostringstream functionsOutput;  // Functions go here (before main)
-    std::ostringstream mainOutput;       // Main code goes here
-    std::ostringstream* currentOutput;   // Pointer to current output stream
-    int indentLevel = 1;
-    bool inFunction = false;
-    std::unordered_set<std::string> declaredFunctions;
-    std::unordered_map<std::string, ExprType> varTypes;
+    // C signature for a clone, e.g. "int f(int a, char* b)"
+    std::string functionSignature(const FunctionInfo& info, const Specialization& spec) const {
+        std::ostringstream sig;
+        // @sisip bodies the inliner could not substitute are left to gcc
+        if (info.annotations.count("sisip")) sig << "static inline ";
+        sig << cTypeName(spec.returnType) << " " << spec.cName << "(";
+        for (size_t i = 0; i < info.params.size(); i++) {
+            if (i > 0) sig << ", ";
+            sig << cTypeName(spec.paramTypes[i]) << " " << info.params[i];
+        }
+        sig << ")";
+        return sig.str();
+    }
     
-    Token current() const {
-        return pos < tokens.size() ? tokens[pos] : tokens.back();
+    // Function declarations are generated from the index; skip them in place
+    void generateFunctionDecl() {
+        advance(); // skip 'fungsi'
+        auto it = functions.find(current().value);
+        if (it != functions.end()) {
+            pos = it->second.end;
+        }
     }
     
-    Token peek(int offset = 1) const {
-        size_t idx = pos + offset;
-        return idx < tokens.size() ? tokens[idx] : tokens.back();
+    // Generate one clone of a function into its own buffer (stored.code)
+    void generateFunction(const std::string& name, Specialization& stored) {
+        const FunctionInfo& info = functions.at(name);
+        Specialization spec = stored;
+        
+        // Switch to a private output
+        std::ostringstream body;
+        std::ostringstream* prevOutput = currentOutput;
+        currentOutput = &body;
+        int prevIndent = indentLevel;
+        indentLevel = 1;
+        inFunction = true;
+        currentFunction = name;
+        currentParamTypes = spec.paramTypes;
+        currentUsesTailLoop = false;
+        currentReturn = ExprType::UNKNOWN;
+        currentKnownReturn = info.returnType != ExprType::UNKNOWN ? info.returnType : spec.returnType;
+        if (info.generator && info.annotations.count("ingat")) {
+            std::cerr << "Error: Generator '" << name << "' cannot be @ingat" << std::endl;
+            std::exit(1);
+        }
+        inGenerator = info.generator;
+        yieldCounter = 0;
+        int prevIterators = iteratorCounter;
+        iteratorCounter = 0;
+        generatorLocals.clear();
+        generatorIterators.clear();
+        
+        // Parameters are the only variables visible in the body
+        std::unordered_map<std::string, ExprType> prevVarTypes = varTypes;
+        varTypes.clear();
+        for (size_t i = 0; i < info.params.size(); i++) {
+            varTypes[info.params[i]] = spec.paramTypes[i];
+            if (inGenerator) generatorLocals.push_back({info.params[i], spec.paramTypes[i]});
+        }
+        
+        size_t prevPos = pos;
+        pos = info.bodyStart;
+        expect(TokenType::LBRACE, "Expected '{' to start function body");
+        
+        while (!check(TokenType::RBRACE) && !check(TokenType::END_OF_FILE)) {
+            generateStatement();
+        }
+        
+        expect(TokenType::RBRACE, "Expected '}' to end function body");
+        
+        stored.observedReturn = info.returnType != ExprType::UNKNOWN ? info.returnType : currentReturn;
+        // Self tail calls jump back here with the parameters reassigned
+        std::string loopLabel = currentUsesTailLoop ? "__wear_tail:;\n" : "";
+        if (info.generator) {
+            finishGenerator(info, stored, body.str());
+        } else if (info.annotations.count("ingat") && isMemoizable(stored)) {
+            stored.code = memoizedFunction(info, stored, loopLabel + body.str());
+        } else {
+            if (info.annotations.count("ingat")) uncachedClones.insert(stored.cName);
+            stored.code = functionSignature(info, spec) + " {\n" + loopLabel + body.str() + "}\n\n";
+        }
+        
+        // Switch back to main output
+        pos = prevPos;
+        varTypes = prevVarTypes;
+        currentFunction.clear();
+        inFunction = false;
+        inGenerator = false;
+        iteratorCounter = prevIterators;
+        indentLevel = prevIndent;
+        currentOutput = prevOutput;
     }
     
-    void advance() {
-        if (pos < tokens.size()) pos++;
+    // The cache keys ints, strings and views (by their bytes) and stores
+    // ints and strings (a view result is stored as a copy); clones taking
+    // or returning anything else run uncached, with a warning
+    static bool isMemoizable(const Specialization& spec) {
+        for (ExprType t : spec.paramTypes) {
+            if (t != ExprType::INT && t != ExprType::STRING && t != ExprType::VIEW) return false;
+        }
+        ExprType r = spec.returnType;
+        return r == ExprType::INT || r == ExprType::STRING || r == ExprType::VIEW;
     }
     
-    bool match(TokenType type) {
-        if (current().type == type) {
-            advance();
-            return true;
+    // @ingat: the body becomes a static helper and the clone itself looks
+    // the arguments up in a per-clone cache first. Recursive calls go through
+    // the cache as well.
+    std::string memoizedFunction(const FunctionInfo& info, const Specialization& spec, const std::string& body) {
+        Specialization inner = spec;
+        inner.cName = "__wear_ingat_" + spec.cName;
+        std::string table = "__wear_memo_" + spec.cName;
+        int limit = std::atoi(info.annotations.at("ingat").c_str());
+        bool isView = spec.returnType == ExprType::VIEW;
+        bool isString = spec.returnType == ExprType::STRING || isView;
+        
+        std::ostringstream code;
+        code << "static __wear_memo " << table << " = {\"" << info.name << "\", " << limit << "};\n\n";
+        code << (info.annotations.count("sisip") ? "" : "static ") << functionSignature(info, inner)
+             << " {\n" << body << "}\n\n";
+        
+        code << functionSignature(info, spec) << " {\n";
+        code << "    __wear_memo_key __key;\n";
+        code << "    __wear_memo_key_init(&__key);\n";
+        for (size_t i = 0; i < info.params.size(); i++) {
+            ExprType t = spec.paramTypes[i];
+            const char* put = t == ExprType::STRING ? "__wear_memo_key_str"
+                            : t == ExprType::VIEW ? "__wear_memo_key_view" : "__wear_memo_key_int";
+            code << "    " << put << "(&__key, " << info.params[i] << ");\n";
         }
-        return false;
+        code << "    " << (isString ? "char*" : "int") << " __hit;\n";
+        code << "    if (" << (isString ? "__wear_memo_find_str" : "__wear_memo_find_int") << "(&" << table
+             << ", &__key, &__hit)) {\n";
+        code << "        __wear_memo_key_free(&__key);\n";
+        code << "        return " << (isView ? "__wear_view_of(__hit)" : "__hit") << ";\n";
+        code << "    }\n";
+        code << "    " << cTypeName(spec.returnType) << " __result = " << inner.cName << "(";
+        for (size_t i = 0; i < info.params.size(); i++) {
+            code << (i > 0 ? ", " : "") << info.params[i];
+        }
+        code << ");\n";
+        code << "    " << (isString ? "__wear_memo_store_str" : "__wear_memo_store_int")
+             << "(&" << table << ", &__key, " << (isView ? "__wear_view_str(__result)" : "__result") << ");\n";
+        code << "    __wear_memo_key_free(&__key);\n";
+        code << "    return __result;\n";
+        code << "}\n\n";
+        return code.str();
     }
     
-    bool check(TokenType type) const {
-        return current().type == type;
+    // Generate every clone requested so far (generating may request more)
+    //
+    // Clones are generated a wave at a time: each clone queued so far gets
+    // a worker of its own, the workers run in parallel, and their results
+    // are taken over in queue order. The clones they request make up the
+    // next wave. That is the order in which a single queue would have
+    // generated them, so the output is the same for any number of threads.
+    void drainSpecQueue() {
+        while (!specQueue.empty()) {
+            std::vector<std::pair<std::string, size_t>> wave;
+            wave.swap(specQueue);
+            std::vector<Specialization> clones;
+            for (const auto& next : wave) clones.push_back(specializations[next.first][next.second]);
+            
+            std::vector<std::unique_ptr<CodeGenerator>> workers(wave.size());
+            runParallel(wave.size(), [&](size_t i) {
+                workers[i].reset(new CodeGenerator(this));
+                workers[i]->generateFunction(wave[i].first, clones[i]);
+            });
+            for (size_t i = 0; i < wave.size(); i++) {
+                adoptClone(*workers[i], clones[i]);
+                specializations[wave[i].first][wave[i].second] = clones[i];
+                workers[i].reset();
+            }
+        }
+    }
+    
+    // Numbers in generated names count across the whole program, which a
+    // worker cannot know: it writes "\x01<kind><its own count>\x02" and
+    // adoptClone fills in the number ('w' workers, 'b' builders) or the
+    // table name ('p' patterns, 's' scan classes)
+    std::string programNumber(char kind, int n) const {
+        return isWorker ? std::string("\x01") + kind + std::to_string(n) + "\x02" : std::to_string(n);
+    }
+    
+    // Take over a clone generated by a worker: create the tables it used,
+    // number its names after everything generated so far, queue the clones
+    // it requested and keep what it noted
+    void adoptClone(const CodeGenerator& worker, Specialization& clone) {
+        std::vector<std::string> patterns;
+        std::vector<std::string> scans;
+        for (const auto& literal : worker.deferredPatterns) patterns.push_back(patternTable(literal));
+        for (const auto& contents : worker.deferredScans) scans.push_back(scanClassTable(contents));
+        int workerBase = workerCounter;
+        int builderBase = builderCounter;
+        workerCounter += worker.workerCounter;
+        builderCounter += worker.builderCounter;
+        
+        auto fill = [&](const std::string& text) {
+            std::string out;
+            size_t done = 0;
+            for (size_t at = text.find('\x01'); at != std::string::npos; at = text.find('\x01', done)) {
+                int n = std::atoi(text.c_str() + at + 2);
+                out.append(text, done, at - done);
+                switch (text[at + 1]) {
+                    case 'w': out += std::to_string(workerBase + n); break;
+                    case 'b': out += std::to_string(builderBase + n); break;
+                    case 'p': out += patterns[n - 1]; break;
+                    default: out += scans[n - 1]; break;
+                }
+                done = text.find('\x02', at) + 1;
+            }
+            return out.append(text, done, std::string::npos);
+        };
+        clone.code = fill(clone.code);
+        workersOutput << fill(worker.workersOutput.str());
+        
+        usesSort |= worker.usesSort;
+        usesVector |= worker.usesVector;
+        usesParalel |= worker.usesParalel;
+        usesTasks |= worker.usesTasks;
+        usesChannels |= worker.usesChannels;
+        usesAtomics |= worker.usesAtomics;
+        usesFiles |= worker.usesFiles;
+        returnConflicts.insert(worker.returnConflicts.begin(), worker.returnConflicts.end());
+        assignConflicts.insert(worker.assignConflicts.begin(), worker.assignConflicts.end());
+        tailCalls.insert(tailCalls.end(), worker.tailCalls.begin(), worker.tailCalls.end());
+        for (const auto& call : worker.keptTailCalls) noteKeptTailCall(call);
+        uncachedClones.insert(worker.uncachedClones.begin(), worker.uncachedClones.end());
+        for (const auto& note : worker.autoParalelNotes) autoParalelNotes[note.first] = note.second;
+        for (const auto& request : worker.requestedClones) {
+            requestSpecialization(functions.at(request.first), request.second);
+        }
+    }
+    
+    // A worker for drainSpecQueue: shares the parent's tokens and tables,
+    // which nobody changes while clones are generated, and has all other
+    // state to itself
+    explicit CodeGenerator(const CodeGenerator* parent)
+        : tokens(parent->tokens), functions(parent->functions), knownReturns(parent->knownReturns),
+          knownSpecCounts(parent->knownSpecCounts), pureFunctions(parent->pureFunctions) {
+        currentOutput = &mainOutput;
+        memoStats = parent->memoStats;
+        autoParalel = parent->autoParalel;
+        isWorker = true;
     }
     
-    void expect(TokenType type, const std::string& message) {
-        if (!match(type)) {
-            std::cerr << "Error at line " << current().line 
-                      << ", column " << current().column 
-                      << ": " << message << std::endl;
-            std::exit(1);
+    // One full generation pass using the return types of the previous pass
+    void runPass() {
+        mainOutput.str("");
+        specializations.clear();
+        specQueue.clear();
+        returnConflicts.clear();
+        assignConflicts.clear();
+        tailCalls.clear();
+        keptTailCalls.clear();
+        uncachedClones.clear();
+        autoParalelNotes.clear();
+        builderCounter = 0;
+        usesSort = false;
+        usesVector = false;
+        usesParalel = false;
+        usesTasks = false;
+        usesChannels = false;
+        usesAtomics = false;
+        usesFiles = false;
+        workersOutput.str("");
+        workerCounter = 0;
+        scanTables.clear();
+        scanTablesOutput.str("");
+        patternTables.clear();
+        patternTablesOutput.str("");
+        varTypes.clear();
+        currentOutput = &mainOutput;
+        indentLevel = 1;
+        pos = 0;
+        
+        // Generate top-level statements into mainOutput
+        while (!check(TokenType::END_OF_FILE)) {
+            if (check(TokenType::RBRACE)) {
+                std::cerr << "Error at line " << current().line
+                          << ": Unexpected '}' outside of a block" << std::endl;
+                std::exit(1);
+            }
+            generateStatement();
         }
+        // Only functions reachable from main's statements get clones;
+        // everything else is dropped from the output
+        drainSpecQueue();
     }
     
-    std::string indent() const {
-        return std::string(indentLevel * 4, ' ');
-    }
+    // ============================================================
+    // Inliner (token-level, runs before type inference)
+    // ============================================================
     
-    void emitLine(const std::string& code) {
-        *currentOutput << indent() << code << "\n";
+    static const size_t inlineCostLimit = 16;   // Body tokens a function may have to be inlined unasked
+    static const int inlineRounds = 4;          // Nesting depth for inlined bodies calling inlinable ones
+    
+    // Tokens of an expression up to the end of the statement (depth-aware)
+    bool collectExpression(size_t& i, size_t end, std::vector<Token>& out) const {
+        int depth = 0;
+        while (i < end) {
+            TokenType t = tokens[i].type;
+            if (depth == 0 && (t == TokenType::NEWLINE || t == TokenType::RBRACE ||
+                               t == TokenType::SEMICOLON)) break;
+            if (t == TokenType::LPAREN) depth++;
+            if (t == TokenType::RPAREN) depth--;
+            if (t == TokenType::LBRACE || t == TokenType::VAR || t == TokenType::CETAK ||
+                t == TokenType::KEMBALIKAN || t == TokenType::QUESTION) return false;
+            out.push_back(tokens[i]);
+            i++;
+        }
+        return !out.empty() && depth == 0;
     }
     
-    void emit(const std::string& code) {
-        *currentOutput << code;
+    // Expression form of a function body: 'kembalikan e', optionally after
+    // guards 'jika (c) { kembalikan e }', becomes ((c) ? (e) : (...)).
+    // Returns false when the body has any other shape.
+    bool inlineExpression(const FunctionInfo& info, std::vector<Token>& expr, size_t& cost) const {
+        std::vector<std::pair<std::vector<Token>, std::vector<Token>>> guards;
+        std::vector<Token> last;
+        size_t i = info.bodyStart + 1;
+        size_t end = info.end - 1;
+        cost = 0;
+        
+        auto skipNewlines = [&]() {
+            while (i < end && tokens[i].type == TokenType::NEWLINE) i++;
+        };
+        
+        skipNewlines();
+        while (i < end) {
+            if (tokens[i].type == TokenType::JIKA) {
+                std::vector<Token> cond, value;
+                i++;
+                if (i >= end || tokens[i].type != TokenType::LPAREN) return false;
+                // Condition is everything up to the matching ')'
+                int depth = 0;
+                size_t j = i;
+                for (; j < end; j++) {
+                    if (tokens[j].type == TokenType::LPAREN) depth++;
+                    if (tokens[j].type == TokenType::RPAREN && --depth == 0) break;
+                }
+                if (j >= end) return false;
+                cond.assign(tokens.begin() + i + 1, tokens.begin() + j);
+                i = j + 1;
+                if (i >= end || tokens[i].type != TokenType::LBRACE) return false;
+                i++;
+                skipNewlines();
+                if (i >= end || tokens[i].type != TokenType::KEMBALIKAN) return false;
+                i++;
+                if (!collectExpression(i, end, value)) return false;
+                skipNewlines();
+                if (i >= end || tokens[i].type != TokenType::RBRACE) return false;
+                i++;
+                if (i < end && tokens[i].type == TokenType::LAINNYA) return false;
+                cost += cond.size() + value.size();
+                guards.push_back({cond, value});
+            } else if (tokens[i].type == TokenType::KEMBALIKAN) {
+                i++;
+                if (!collectExpression(i, end, last)) return false;
+                skipNewlines();
+                if (i != end) return false;
+                cost += last.size();
+                break;
+            } else {
+                return false;
+            }
+            skipNewlines();
+        }
+        if (last.empty()) return false;
+        
+        const Token& at = tokens[info.bodyStart];
+        auto tok = [&](TokenType type, const std::string& value) { return Token(type, value, at.line, at.column); };
+        auto wrap = [&](const std::vector<Token>& inner) {
+            std::vector<Token> out;
+            out.push_back(tok(TokenType::LPAREN, "("));
+            out.insert(out.end(), inner.begin(), inner.end());
+            out.push_back(tok(TokenType::RPAREN, ")"));
+            return out;
+        };
+        
+        expr = wrap(last);
+        for (size_t g = guards.size(); g-- > 0;) {
+            std::vector<Token> chain = wrap(guards[g].first);
+            chain.push_back(tok(TokenType::QUESTION, "?"));
+            auto value = wrap(guards[g].second);
+            chain.insert(chain.end(), value.begin(), value.end());
+            chain.push_back(tok(TokenType::COLON, ":"));
+            chain.insert(chain.end(), expr.begin(), expr.end());
+            expr = wrap(chain);
+        }
+        return true;
     }
     
-    // Check if identifier is a string variable
-    bool isStringVar(const std::string& name) {
-        auto it = varTypes.find(name);
-        return it != varTypes.end() && it->second == ExprType::STRING;
+    // Whether an argument may be evaluated zero or one times instead of once
+    bool isReorderSafe(const std::vector<Token>& arg) const {
+        for (size_t i = 0; i < arg.size(); i++) {
+            TokenType t = arg[i].type;
+            if (t == TokenType::BACA_FILE || t == TokenType::TULIS_FILE || t == TokenType::URUTKAN ||
+                t == TokenType::JALANKAN || t == TokenType::TUNGGU) {
+                return false;  // Reads input, writes files, sorts in place or waits
+            }
+            if (t == TokenType::IDENTIFIER && i + 1 < arg.size() && arg[i + 1].type == TokenType::LPAREN) {
+                return false;  // User functions and named builtins may have effects
+            }
+        }
+        return true;
     }
     
-    ExprResult generateTypedExpression() {
-        std::vector<std::pair<std::string, ExprType>> parts;
-        int parenDepth = 0;
+    // Substitute small expression-bodied functions at their call sites.
+    // Returns true when any call was replaced (tokens are then re-indexed).
+    bool inlineSmallFunctions() {
+        std::unordered_map<std::string, std::vector<Token>> candidates;
+        for (const auto& name : functionOrder) {
+            const FunctionInfo& info = functions[name];
+            std::vector<Token> expr;
+            size_t cost = 0;
+            if (info.annotations.count("ingat")) continue;   // Calls must reach the cache
+            if (!inlineExpression(info, expr, cost)) continue;
+            if (cost > inlineCostLimit && !info.annotations.count("sisip")) continue;
+            
+            bool recursive = false;
+            for (const auto& t : expr) {
+                if (t.type == TokenType::IDENTIFIER && t.value == name) recursive = true;
+            }
+            if (!recursive) candidates[name] = expr;
+        }
+        if (candidates.empty()) return false;
         
-        while (!check(TokenType::END_OF_FILE)) {
-            Token tok = current();
+        std::vector<Token> out;
+        bool changed = false;
+        for (size_t i = 0; i < tokens.size(); i++) {
+            const Token& t = tokens[i];
+            auto cand = t.type == TokenType::IDENTIFIER ? candidates.find(t.value) : candidates.end();
             
-            // Stop conditions (outside parens)
-            if (parenDepth == 0) {
-                if (tok.type == TokenType::RPAREN ||
-                    tok.type == TokenType::LBRACE ||
-                    tok.type == TokenType::RBRACE ||
-                    tok.type == TokenType::COMMA ||
-                    tok.type == TokenType::SEMICOLON ||
-                    tok.type == TokenType::NEWLINE) {
-                    break;
+            // Only calls in expression position ('f(x)' as a statement has no value to use)
+            bool isCall = cand != candidates.end() && i + 1 < tokens.size() &&
+                          tokens[i + 1].type == TokenType::LPAREN && i > 0 &&
+                          tokens[i - 1].type != TokenType::FUNGSI &&
+                          tokens[i - 1].type != TokenType::JALANKAN &&
+                          tokens[i - 1].type != TokenType::NEWLINE &&
+                          tokens[i - 1].type != TokenType::LBRACE &&
+                          tokens[i - 1].type != TokenType::RBRACE;
+            if (!isCall) {
+                out.push_back(t);
+                continue;
+            }
+            
+            // Split the argument list at top-level commas
+            std::vector<std::vector<Token>> args(1);
+            int depth = 0;
+            size_t j = i + 1;
+            for (; j < tokens.size(); j++) {
+                TokenType tt = tokens[j].type;
+                if (tt == TokenType::LPAREN && depth++ == 0) continue;
+                if (tt == TokenType::RPAREN && --depth == 0) break;
+                if (tt == TokenType::COMMA && depth == 1) {
+                    args.emplace_back();
+                    continue;
                 }
+                if (tt == TokenType::END_OF_FILE) break;
+                args.back().push_back(tokens[j]);
             }
+            if (args.size() == 1 && args[0].empty()) args.clear();
             
-            if (tok.type == TokenType::STRING) {
-                parts.push_back({"\"" + tok.value + "\"", ExprType::STRING});
-                advance();
-            } else if (tok.type == TokenType::INTEGER) {
-                parts.push_back({tok.value, ExprType::INT});
-                advance();
-            } else if (tok.type == TokenType::BACA_FILE) {
-                // baca_file("filename")
-                advance();
-                expect(TokenType::LPAREN, "Expected '(' after 'baca_file'");
-                auto arg = generateTypedExpression();
-                expect(TokenType::RPAREN, "Expected ')'");
-                parts.push_back({"__wear_read_file(" + arg.code + ")", ExprType::STRING});
-            } else if (tok.type == TokenType::SAMA) {
-                // sama(str1, str2) - string comparison
-                advance();
-                expect(TokenType::LPAREN, "Expected '(' after 'sama'");
-                auto arg1 = generateTypedExpression();
-                expect(TokenType::COMMA, "Expected ',' between arguments");
-                auto arg2 = generateTypedExpression();
-                expect(TokenType::RPAREN, "Expected ')'");
-                parts.push_back({"__wear_streq(" + arg1.code + ", " + arg2.code + ")", ExprType::INT});
-            } else if (tok.type == TokenType::PANJANG) {
-                // panjang(str) - string length
-                advance();
-                expect(TokenType::LPAREN, "Expected '(' after 'panjang'");
-                auto arg = generateTypedExpression();
-                expect(TokenType::RPAREN, "Expected ')'");
-                parts.push_back({"__wear_strlen(" + arg.code + ")", ExprType::INT});
-            } else if (tok.type == TokenType::CHAR_AT) {
-                // char_at(str, index) - character at index
-                advance();
-                expect(TokenType::LPAREN, "Expected '(' after 'char_at'");
-                auto str = generateTypedExpression();
-                expect(TokenType::COMMA, "Expected ',' between arguments");
-                auto idx = generateTypedExpression();
-                expect(TokenType::RPAREN, "Expected ')'");
-                parts.push_back({"__wear_char_at(" + str.code + ", " + idx.code + ")", ExprType::STRING});
-            } else if (tok.type == TokenType::IS_QUOTE) {
-                // is_quote(char) - check if character is quote
-                advance();
-                expect(TokenType::LPAREN, "Expected '(' after 'is_quote'");
-                auto arg = generateTypedExpression();
-                expect(TokenType::RPAREN, "Expected ')'");
-                parts.push_back({"__wear_is_quote(" + arg.code + ")", ExprType::INT});
-            } else if (tok.type == TokenType::QUOTE_CHAR) {
-                // quote_char() - get quote character as string
-                advance();
-                expect(TokenType::LPAREN, "Expected '(' after 'quote_char'");
-                expect(TokenType::RPAREN, "Expected ')'");
-                parts.push_back({"__wear_quote_char()", ExprType::STRING});
-            } else if (tok.type == TokenType::IS_NEWLINE) {
-                // is_newline(char) - check if character is newline
-                advance();
-                expect(TokenType::LPAREN, "Expected '(' after 'is_newline'");
-                auto arg = generateTypedExpression();
-                expect(TokenType::RPAREN, "Expected ')'");
-                parts.push_back({"__wear_is_newline(" + arg.code + ")", ExprType::INT});
-            } else if (tok.type == TokenType::NEWLINE_CHAR) {
-                // newline_char() - get newline character as string
-                advance();
-                expect(TokenType::LPAREN, "Expected '(' after 'newline_char'");
-                expect(TokenType::RPAREN, "Expected ')'");
-                parts.push_back({"__wear_newline_char()", ExprType::STRING});
-            } else if (tok.type == TokenType::IDENTIFIER) {
-                std::string name = tok.value;
-                advance();
+            const FunctionInfo& info = functions[t.value];
+            bool ok = j < tokens.size() && tokens[j].type == TokenType::RPAREN &&
+                      args.size() == info.params.size();
+            
+            // Single tokens (and negative literals) are copied freely; larger
+            // arguments only when safe to evaluate conditionally or not at all
+            // (a parameter the body never reads drops its argument)
+            auto simple = [](const std::vector<Token>& arg) {
+                return arg.size() == 1 ||
+                       (arg.size() == 2 && arg[0].type == TokenType::MINUS && arg[1].type == TokenType::INTEGER);
+            };
+            for (size_t p = 0; ok && p < args.size(); p++) {
+                if (!simple(args[p]) && !isReorderSafe(args[p])) ok = false;
+            }
+            
+            // Build the substituted expression
+            std::vector<Token> body;
+            for (size_t k = 0; ok && k < cand->second.size(); k++) {
+                const Token& bt = cand->second[k];
+                size_t p = 0;
+                while (bt.type == TokenType::IDENTIFIER && p < info.params.size() && info.params[p] != bt.value) p++;
+                if (bt.type != TokenType::IDENTIFIER || p == info.params.size()) {
+                    body.push_back(Token(bt.type, bt.value, t.line, t.column));
+                    continue;
+                }
                 
-                // Check for function call
-                if (check(TokenType::LPAREN)) {
-                    std::ostringstream call;
-                    call << name << "(";
-                    expect(TokenType::LPAREN, "Expected '('");
-                    
-                    bool first = true;
-                    while (!check(TokenType::RPAREN) && !check(TokenType::END_OF_FILE)) {
-                        if (!first) {
-                            expect(TokenType::COMMA, "Expected ','");
-                            call << ", ";
-                        }
-                        first = false;
-                        auto arg = generateTypedExpression();
-                        call << arg.code;
+                // Larger arguments are substituted only where used once
+                const auto& arg = args[p];
+                if (!simple(arg)) {
+                    size_t uses = 0;
+                    for (const auto& u : cand->second) {
+                        if (u.type == TokenType::IDENTIFIER && u.value == bt.value) uses++;
                     }
-                    
-                    expect(TokenType::RPAREN, "Expected ')'");
-                    call << ")";
-                    
-                    // Assume function returns int (could be enhanced)
-                    parts.push_back({call.str(), ExprType::INT});
+                    if (uses != 1) {
+                        ok = false;
+                        break;
+                    }
+                }
+                if (arg.size() == 1) {
+                    body.push_back(arg[0]);
                 } else {
-                    // Variable reference
-                    ExprType vType = isStringVar(name) ? ExprType::STRING : ExprType::INT;
-                    parts.push_back({name, vType});
+                    body.push_back(Token(TokenType::LPAREN, "(", t.line, t.column));
+                    body.insert(body.end(), arg.begin(), arg.end());
+                    body.push_back(Token(TokenType::RPAREN, ")", t.line, t.column));
                 }
-            } else if (tok.type == TokenType::PLUS) {
-                parts.push_back({"+", ExprType::UNKNOWN});
-                advance();
-            } else if (tok.type == TokenType::MINUS) {
-                parts.push_back({"-", ExprType::UNKNOWN});
-                advance();
-            } else if (tok.type == TokenType::STAR) {
-                parts.push_back({"*", ExprType::UNKNOWN});
-                advance();
-            } else if (tok.type == TokenType::SLASH) {
-                parts.push_back({"/", ExprType::UNKNOWN});
-                advance();
-            } else if (tok.type == TokenType::LESS) {
-                parts.push_back({"<", ExprType::UNKNOWN});
-                advance();
-            } else if (tok.type == TokenType::GREATER) {
-                parts.push_back({">", ExprType::UNKNOWN});
-                advance();
-            } else if (tok.type == TokenType::LESS_EQUAL) {
-                parts.push_back({"<=", ExprType::UNKNOWN});
-                advance();
-            } else if (tok.type == TokenType::GREATER_EQUAL) {
-                parts.push_back({">=", ExprType::UNKNOWN});
-                advance();
-            } else if (tok.type == TokenType::EQUAL_EQUAL) {
-                parts.push_back({"==", ExprType::UNKNOWN});
-                advance();
-            } else if (tok.type == TokenType::NOT_EQUAL) {
-                parts.push_back({"!=", ExprType::UNKNOWN});
-                advance();
-            } else if (tok.type == TokenType::LPAREN) {
-                parts.push_back({"(", ExprType::UNKNOWN});
-                parenDepth++;
-                advance();
-            } else if (tok.type == TokenType::RPAREN) {
-                parts.push_back({")", ExprType::UNKNOWN});
-                parenDepth--;
-                advance();
-            } else {
-                break;
             }
+            
+            if (!ok) {
+                out.push_back(t);
+                continue;
+            }
+            out.insert(out.end(), body.begin(), body.end());
+            inlinedFunctions.insert(t.value);
+            i = j;
+            changed = true;
         }
         
-        // Check if this is a string concatenation expression
-        bool hasString = false;
-        bool hasPlus = false;
-        for (const auto& p : parts) {
-            if (p.second == ExprType::STRING) hasString = true;
-            if (p.first == "+") hasPlus = true;
+        if (changed) {
+            tokens = out;
+            indexFunctions();
+        }
+        return changed;
+    }
+    
+    // ============================================================
+    // Dead code elimination
+    // ============================================================
+    
+    // Marks tokens that belong to a function declaration (with its annotations)
+    std::vector<bool> functionTokenMask() const {
+        std::vector<bool> mask(tokens.size(), false);
+        for (const auto& entry : functions) {
+            size_t start = entry.second.bodyStart;
+            while (start > 0 && tokens[start].type != TokenType::FUNGSI) start--;
+            // Walk back over the '@name' / '@name(arg)' lines above it
+            while (start > 0) {
+                size_t k = start - 1;
+                while (k > 0 && tokens[k].type == TokenType::NEWLINE) k--;
+                if (tokens[k].type == TokenType::RPAREN && k >= 3 &&
+                    tokens[k - 2].type == TokenType::LPAREN && tokens[k - 3].type == TokenType::ANNOTATION) {
+                    k -= 3;
+                }
+                if (tokens[k].type != TokenType::ANNOTATION) break;
+                start = k;
+            }
+            for (size_t i = start; i < entry.second.end; i++) mask[i] = true;
+        }
+        return mask;
+    }
+    
+    // Whether a constant initializer can be dropped without losing an effect
+    static bool isDroppableInitializer(TokenType type) {
+        switch (type) {
+            case TokenType::INTEGER: case TokenType::STRING: case TokenType::IDENTIFIER:
+            case TokenType::PLUS: case TokenType::MINUS: case TokenType::STAR: case TokenType::SLASH:
+            case TokenType::LESS: case TokenType::GREATER: case TokenType::LESS_EQUAL:
+            case TokenType::GREATER_EQUAL: case TokenType::EQUAL_EQUAL: case TokenType::NOT_EQUAL:
+            case TokenType::LPAREN: case TokenType::RPAREN: case TokenType::COMMA:
+            case TokenType::QUESTION: case TokenType::COLON: case TokenType::REGEX:
+                return true;
+            default:
+                return isPureBuiltin(type);
         }
+    }
+    
+    // Drop top-level 'var X = <pure expression>' when X is never mentioned
+    // again in top-level code (function bodies cannot see main's variables).
+    // Returns true when anything was removed.
+    bool eliminateDeadConstants() {
+        std::vector<bool> inFunction = functionTokenMask();
         
-        if (hasString && hasPlus && parts.size() >= 3) {
-            // Build string concatenation chain
-            return buildStringConcat(parts);
+        std::unordered_map<std::string, int> uses;
+        for (size_t i = 0; i < tokens.size(); i++) {
+            if (!inFunction[i] && tokens[i].type == TokenType::IDENTIFIER) uses[tokens[i].value]++;
         }
         
-        // Regular expression
-        std::ostringstream result;
-        ExprType resultType = ExprType::INT;
-        for (const auto& p : parts) {
-            result << p.first;
-            if (p.second == ExprType::STRING) resultType = ExprType::STRING;
+        std::vector<bool> removed(tokens.size(), false);
+        bool any = false;
+        int depth = 0;
+        for (size_t i = 0; i + 2 < tokens.size(); i++) {
+            if (inFunction[i]) continue;
+            if (tokens[i].type == TokenType::LBRACE) depth++;
+            if (tokens[i].type == TokenType::RBRACE) depth--;
+            if (depth != 0 || tokens[i].type != TokenType::VAR ||
+                tokens[i + 1].type != TokenType::IDENTIFIER || tokens[i + 2].type != TokenType::EQUAL) {
+                continue;
+            }
+            const std::string& name = tokens[i + 1].value;
+            if (uses[name] != 1) continue;
+            
+            size_t end = i + 3;
+            bool pure = true;
+            while (end < tokens.size() && tokens[end].type != TokenType::NEWLINE &&
+                   tokens[end].type != TokenType::END_OF_FILE) {
+                bool isCall = tokens[end].type == TokenType::IDENTIFIER && end + 1 < tokens.size() &&
+                              tokens[end + 1].type == TokenType::LPAREN;
+                if (isCall || !isDroppableInitializer(tokens[end].type)) pure = false;
+                end++;
+            }
+            if (!pure) continue;
+            
+            for (size_t k = i; k < end; k++) removed[k] = true;
+            removedConstants.push_back(name);
+            any = true;
+            i = end - 1;
         }
         
-        return ExprResult(result.str(), resultType);
+        if (any) {
+            std::vector<Token> kept;
+            for (size_t i = 0; i < tokens.size(); i++) {
+                if (!removed[i]) kept.push_back(tokens[i]);
+            }
+            tokens = kept;
+            indexFunctions();
+        }
+        return any;
     }
     
-    ExprResult buildStringConcat(const std::vector<std::pair<std::string, ExprType>>& parts) {
-        // Build a chain of __wear_concat calls
-        std::vector<std::pair<std::string, ExprType>> operands;
-        
-        for (const auto& p : parts) {
-            if (p.first != "+" && p.first != " ") {
-                operands.push_back(p);
+    // After generation: record dropped functions and which source files
+    // (main file and imports) still contribute code
+    void collectUsage() {
+        std::vector<bool> inFunction = functionTokenMask();
+        for (size_t i = 0; i < tokens.size(); i++) {
+            TokenType t = tokens[i].type;
+            if (!inFunction[i] && t != TokenType::NEWLINE && t != TokenType::END_OF_FILE) {
+                usedFiles.insert(tokens[i].file);
+            }
+        }
+        for (const auto& name : functionOrder) {
+            // Fully inlined functions were used, just not called
+            if (!specializations[name].empty() || inlinedFunctions.count(name)) {
+                usedFiles.insert(tokens[functions[name].bodyStart].file);
+            } else {
+                removedFunctions.push_back(name);
             }
         }
+    }
+    
+    // ============================================================
+    // Pure call optimization (token-level, after inlining)
+    // ============================================================
+    
+    std::set<std::string>& pureFunctions;
+    int pureTempCounter = 0;
+    
+    // Builtins whose result depends only on their arguments. They never
+    // fail, so they may also be evaluated ahead of time.
+    static bool isPureBuiltin(TokenType type) {
+        switch (type) {
+            case TokenType::SAMA: case TokenType::PANJANG: case TokenType::CHAR_AT:
+            case TokenType::IS_QUOTE: case TokenType::QUOTE_CHAR: case TokenType::IS_NEWLINE:
+            case TokenType::NEWLINE_CHAR: case TokenType::KODE_AT:
+            case TokenType::IS_DIGIT_KODE: case TokenType::IS_LETTER_KODE: case TokenType::POTONG:
+            case TokenType::COCOK:
+                return true;
+            default:
+                return false;
+        }
+    }
+    
+    // A user function is pure when it does no I/O, only calls pure functions
+    // and does not touch arrays (they are mutable and shared)
+    void inferPureFunctions() {
+        pureFunctions.clear();
+        for (const auto& name : functionOrder) pureFunctions.insert(name);
         
-        if (operands.empty()) {
-            return ExprResult("\"\"", ExprType::STRING);
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (const auto& name : functionOrder) {
+                if (!pureFunctions.count(name)) continue;
+                const FunctionInfo& info = functions[name];
+                for (size_t i = info.bodyStart; i < info.end; i++) {
+                    TokenType t = tokens[i].type;
+                    bool impureCall = t == TokenType::IDENTIFIER && i + 1 < info.end &&
+                                      tokens[i + 1].type == TokenType::LPAREN &&
+                                      !pureFunctions.count(tokens[i].value);
+                    if (t == TokenType::CETAK || t == TokenType::BACA_FILE ||
+                        t == TokenType::TULIS_FILE || t == TokenType::LBRACKET ||
+                        t == TokenType::PISAH || t == TokenType::URUTKAN ||
+                        t == TokenType::PARALEL || t == TokenType::JALANKAN ||
+                        t == TokenType::TUNGGU || t == TokenType::HASILKAN || impureCall) {
+                        pureFunctions.erase(name);
+                        changed = true;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+    
+    // Length of the pure call starting at body[i] (callee plus parenthesized
+    // arguments), or 0 when there is none. Calls without arguments are cheap
+    // constants and not worth a temporary.
+    size_t pureCallLength(const std::vector<Token>& body, size_t i) const {
+        const Token& t = body[i];
+        bool callee = isPureBuiltin(t.type) ||
+                      (t.type == TokenType::IDENTIFIER && pureFunctions.count(t.value));
+        if (!callee || i + 2 >= body.size() || body[i + 1].type != TokenType::LPAREN ||
+            body[i + 2].type == TokenType::RPAREN) {
+            return 0;
         }
         
-        if (operands.size() == 1) {
-            return ExprResult(operands[0].first, operands[0].second);
+        int depth = 0;
+        for (size_t j = i + 1; j < body.size(); j++) {
+            TokenType tt = body[j].type;
+            if (tt == TokenType::LPAREN) depth++;
+            if (tt == TokenType::RPAREN && --depth == 0) return j + 1 - i;
+            bool userCall = tt == TokenType::IDENTIFIER && j + 1 < body.size() &&
+                            body[j + 1].type == TokenType::LPAREN;
+            if (userCall ? !pureFunctions.count(body[j].value)
+                         : !isDroppableInitializer(tt)) {
+                return 0;
+            }
+        }
+        return 0;
+    }
+    
+    // Whether body[i] writes one of the given variables ('x = ...', 'var x',
+    // 'terima(ch, x)' or 'untuk (x dari ...)')
+    static bool assignsAny(const std::vector<Token>& body, size_t i, const std::set<std::string>& vars) {
+        if (body[i].type != TokenType::IDENTIFIER || !vars.count(body[i].value)) return false;
+        return (i + 1 < body.size() && body[i + 1].type == TokenType::EQUAL) ||
+               (i > 0 && body[i - 1].type == TokenType::VAR) || isReceiveTarget(body, i) ||
+               (i > 1 && body[i - 1].type == TokenType::LPAREN && body[i - 2].type == TokenType::UNTUK);
+    }
+    
+    // body[i] is the variable of 'terima(ch, x)' / 'coba_terima(ch, x)'
+    static bool isReceiveTarget(const std::vector<Token>& body, size_t i) {
+        if (i < 2 || i + 1 >= body.size() || body[i - 1].type != TokenType::COMMA ||
+            body[i + 1].type != TokenType::RPAREN) {
+            return false;
+        }
+        int depth = 0;
+        for (size_t j = i - 1; j > 0; j--) {
+            if (body[j].type == TokenType::RPAREN) depth++;
+            if (body[j].type == TokenType::LPAREN && depth-- == 0) {
+                return body[j - 1].type == TokenType::IDENTIFIER &&
+                       (body[j - 1].value == "terima" || body[j - 1].value == "coba_terima");
+            }
+        }
+        return false;
+    }
+    
+    // Index just past the '}' closing the block opened at or after body[i]
+    static size_t skipBlock(const std::vector<Token>& body, size_t i) {
+        while (i < body.size() && body[i].type != TokenType::LBRACE) i++;
+        int depth = 0;
+        for (; i < body.size(); i++) {
+            if (body[i].type == TokenType::LBRACE) depth++;
+            if (body[i].type == TokenType::RBRACE && --depth == 0) return i + 1;
+        }
+        return body.size();
+    }
+    
+    // Start index of each statement in a block body
+    static std::vector<size_t> statementStarts(const std::vector<Token>& body) {
+        std::vector<size_t> starts;
+        int depth = 0;
+        bool atStart = true;
+        for (size_t i = 0; i < body.size(); i++) {
+            TokenType t = body[i].type;
+            if (t == TokenType::NEWLINE && depth == 0) {
+                atStart = true;
+                continue;
+            }
+            if (atStart) starts.push_back(i);
+            atStart = false;
+            if (t == TokenType::LBRACE || t == TokenType::LPAREN) depth++;
+            if (t == TokenType::RBRACE || t == TokenType::RPAREN) depth--;
+        }
+        return starts;
+    }
+    
+    // Reuse one evaluation of a pure call for the statement at body[start]
+    // and everything after it, as long as none of its inputs change. A call
+    // inside a 'selama' whose body leaves its inputs alone is hoisted out of
+    // the loop. Returns true when the body was rewritten.
+    bool reusePureCall(std::vector<Token>& body, size_t start) {
+        size_t stmtEnd = start;
+        int nesting = 0;
+        for (; stmtEnd < body.size(); stmtEnd++) {
+            TokenType t = body[stmtEnd].type;
+            if (t == TokenType::NEWLINE && nesting == 0) break;
+            if (t == TokenType::LBRACE || t == TokenType::LPAREN) nesting++;
+            if (t == TokenType::RBRACE || t == TokenType::RPAREN) nesting--;
         }
         
-        // Build nested concat calls
-        std::string result = operands[0].first;
-        ExprType prevType = operands[0].second;
+        // 'var x = <call>' already names the value
+        bool isBinding = body[start].type == TokenType::VAR && start + 3 < stmtEnd &&
+                         pureCallLength(body, start + 3) == stmtEnd - start - 3;
         
-        for (size_t i = 1; i < operands.size(); i++) {
-            std::string op = operands[i].first;
-            ExprType opType = operands[i].second;
+        // Conditions of a 'selama' run at least once, so user functions called
+        // there (outside an inlined '?') can be evaluated up front as well
+        size_t condEnd = start;
+        if (body[start].type == TokenType::SELAMA) {
+            int depth = 0;
+            for (condEnd = start + 1; condEnd < body.size(); condEnd++) {
+                if (body[condEnd].type == TokenType::QUESTION) break;
+                if (body[condEnd].type == TokenType::LPAREN) depth++;
+                if (body[condEnd].type == TokenType::RPAREN && --depth == 0) break;
+            }
+        }
+        
+        std::set<std::string> tried;
+        for (size_t i = start; i < stmtEnd; i++) {
+            size_t len = pureCallLength(body, i);
+            if (len == 0) continue;
+            std::string bound = isBinding && i == start + 3 ? body[start + 1].value : "";
             
-            if (prevType == ExprType::STRING && opType == ExprType::STRING) {
-                result = "__wear_concat(" + result + ", " + op + ")";
-            } else if (prevType == ExprType::STRING && opType == ExprType::INT) {
-                result = "__wear_concat_str_int(" + result + ", " + op + ")";
-            } else if (prevType == ExprType::INT && opType == ExprType::STRING) {
-                result = "__wear_concat_int_str(" + result + ", " + op + ")";
-            } else {
-                // Both int - just add
-                result = "(" + result + " + " + op + ")";
+            std::vector<Token> call(body.begin() + i, body.begin() + i + len);
+            std::string key;
+            std::set<std::string> inputs;
+            for (size_t k = 0; k < call.size(); k++) {
+                key += call[k].value + " ";
+                bool isCallee = k + 1 < call.size() && call[k + 1].type == TokenType::LPAREN;
+                if (call[k].type == TokenType::IDENTIFIER && !isCallee) inputs.insert(call[k].value);
+            }
+            if (!tried.insert(key).second) continue;
+            
+            bool total = true;
+            for (size_t k = 0; k < call.size(); k++) {
+                if (call[k].type == TokenType::IDENTIFIER && k + 1 < call.size() &&
+                    call[k + 1].type == TokenType::LPAREN) total = false;
+            }
+            if (!total && bound.empty() && !(i < condEnd && body[start].type == TokenType::SELAMA)) continue;
+            
+            // Collect the matching calls until an input is written
+            std::set<std::string> killers = inputs;
+            if (!bound.empty()) killers.insert(bound);
+            std::vector<size_t> sites;
+            bool inLoop = false;
+            std::vector<size_t> loopEnds;
+            size_t j = bound.empty() ? start : stmtEnd;
+            for (; j < body.size(); j++) {
+                while (!loopEnds.empty() && j >= loopEnds.back()) loopEnds.pop_back();
+                if (assignsAny(body, j, killers)) break;
+                if (body[j].type == TokenType::SELAMA) {
+                    size_t loopEnd = skipBlock(body, j);
+                    bool writes = false;
+                    for (size_t k = j; k < loopEnd && !writes; k++) writes = assignsAny(body, k, killers);
+                    if (writes) break;
+                    loopEnds.push_back(loopEnd);
+                }
+                if (j + len <= body.size() && std::equal(call.begin(), call.end(), body.begin() + j,
+                        [](const Token& a, const Token& b) { return a.type == b.type && a.value == b.value; })) {
+                    sites.push_back(j);
+                    if (!loopEnds.empty()) inLoop = true;
+                    j += len - 1;
+                }
             }
             
-            // Result of concat is always string
-            if (prevType == ExprType::STRING || opType == ExprType::STRING) {
-                prevType = ExprType::STRING;
+            if (bound.empty() ? (sites.size() < 2 && !inLoop) : sites.empty()) continue;
+            
+            std::string name = bound;
+            if (name.empty()) name = "__wear_pure_" + std::to_string(++pureTempCounter);
+            const Token& at = body[start];
+            for (size_t k = sites.size(); k-- > 0;) {
+                body.erase(body.begin() + sites[k], body.begin() + sites[k] + len);
+                body.insert(body.begin() + sites[k], Token(TokenType::IDENTIFIER, name, at.line, at.column));
+                body[sites[k]].file = at.file;
             }
+            if (bound.empty()) {
+                std::vector<Token> decl;
+                decl.push_back(Token(TokenType::VAR, "var", at.line, at.column));
+                decl.push_back(Token(TokenType::IDENTIFIER, name, at.line, at.column));
+                decl.push_back(Token(TokenType::EQUAL, "=", at.line, at.column));
+                decl.insert(decl.end(), call.begin(), call.end());
+                decl.push_back(Token(TokenType::NEWLINE, "\\n", at.line, at.column));
+                for (auto& d : decl) d.file = at.file;
+                body.insert(body.begin() + start, decl.begin(), decl.end());
+            }
+            return true;
         }
-        
-        return ExprResult(result, ExprType::STRING);
-    }
-    
-    // Simple expression for conditions (no string concat)
-    std::string generateExpression() {
-        auto result = generateTypedExpression();
-        return result.code;
+        return false;
     }
     
-    // Generate print statement
-    void generatePrint() {
-        advance(); // skip 'cetak'
-        
-        auto expr = generateTypedExpression();
+    // Optimize a block body, then the blocks nested in it
+    std::vector<Token> optimizePureCalls(std::vector<Token> body) {
+        std::vector<size_t> starts = statementStarts(body);
+        for (size_t s = 0; s < starts.size(); s++) {
+            // A rewrite inserts a statement here, so look at this one again
+            while (reusePureCall(body, starts[s])) {
+                starts = statementStarts(body);
+            }
+        }
         
-        if (expr.type == ExprType::STRING) {
-            emitLine("__wear_print_str(" + expr.code + ");");
-        } else {
-            emitLine("__wear_print_int(" + expr.code + ");");
+        std::vector<Token> out;
+        for (size_t i = 0; i < body.size(); i++) {
+            out.push_back(body[i]);
+            if (body[i].type != TokenType::LBRACE) continue;
+            size_t end = skipBlock(body, i) - 1;
+            std::vector<Token> inner = optimizePureCalls(
+                std::vector<Token>(body.begin() + i + 1, body.begin() + end));
+            out.insert(out.end(), inner.begin(), inner.end());
+            i = end - 1;
         }
+        return out;
     }
     
-    // Generate variable declaration
-    void generateVarDecl() {
-        advance(); // skip 'var'
-        
-        std::string varName = current().value;
-        advance(); // skip identifier
+    // Run the pure call optimization over main and every function body
+    void optimizePureCallsEverywhere() {
+        std::vector<bool> inFunction = functionTokenMask();
         
-        expect(TokenType::EQUAL, "Expected '=' after variable name");
-        
-        // Check for baca_file or string literal
-        if (check(TokenType::STRING)) {
-            std::string value = current().value;
-            advance();
-            emitLine("char* " + varName + " = \"" + value + "\";");
-            varTypes[varName] = ExprType::STRING;
-        } else if (check(TokenType::BACA_FILE)) {
-            advance();
-            expect(TokenType::LPAREN, "Expected '(' after 'baca_file'");
-            auto arg = generateTypedExpression();
-            expect(TokenType::RPAREN, "Expected ')'");
-            emitLine("char* " + varName + " = __wear_read_file(" + arg.code + ");");
-            varTypes[varName] = ExprType::STRING;
-        } else {
-            auto expr = generateTypedExpression();
-            if (expr.type == ExprType::STRING) {
-                emitLine("char* " + varName + " = " + expr.code + ";");
-                varTypes[varName] = ExprType::STRING;
-            } else {
-                emitLine("int " + varName + " = " + expr.code + ";");
-                varTypes[varName] = ExprType::INT;
+        std::vector<Token> topLevel;
+        std::vector<Token> out;
+        for (size_t i = 0; i < tokens.size(); i++) {
+            if (tokens[i].type == TokenType::END_OF_FILE) break;
+            if (!inFunction[i]) {
+                topLevel.push_back(tokens[i]);
+                continue;
             }
+            if (i > 0 && !inFunction[i - 1]) out.push_back(Token(TokenType::NEWLINE, "\\n", 0, 0));
+            out.push_back(tokens[i]);
+            if (tokens[i].type != TokenType::LBRACE) continue;
+            
+            // Function body: replace its contents, keep the closing '}'
+            size_t end = skipBlock(tokens, i) - 1;
+            std::vector<Token> inner = optimizePureCalls(
+                std::vector<Token>(tokens.begin() + i + 1, tokens.begin() + end));
+            out.insert(out.end(), inner.begin(), inner.end());
+            i = end - 1;
         }
+        
+        // Main's statements follow the functions (their order is irrelevant)
+        out.push_back(Token(TokenType::NEWLINE, "\\n", 0, 0));
+        std::vector<Token> mainBody = optimizePureCalls(topLevel);
+        out.insert(out.end(), mainBody.begin(), mainBody.end());
+        out.push_back(tokens.back());
+        tokens = out;
+        indexFunctions();
     }
     
-    // Generate while loop
-    void generateWhile() {
-        advance(); // skip 'selama'
-        
-        expect(TokenType::LPAREN, "Expected '(' after 'selama'");
-        std::string condition = generateExpression();
-        expect(TokenType::RPAREN, "Expected ')' after condition");
-        
-        emitLine("while (" + condition + ") {");
-        
-        expect(TokenType::LBRACE, "Expected '{' to start while body");
-        indentLevel++;
-        
-        while (!check(TokenType::RBRACE) && !check(TokenType::END_OF_FILE)) {
-            generateStatement();
+    // Clones of one function report the same call once
+    void noteKeptTailCall(const std::string& call) {
+        if (std::find(keptTailCalls.begin(), keptTailCalls.end(), call) == keptTailCalls.end()) {
+            keptTailCalls.push_back(call);
         }
-        
-        indentLevel--;
-        expect(TokenType::RBRACE, "Expected '}' to end while body");
-        emitLine("}");
     }
     
-    // Generate if statement
-    void generateIf() {
-        advance(); // skip 'jika'
-        
-        expect(TokenType::LPAREN, "Expected '(' after 'jika'");
-        std::string condition = generateExpression();
-        expect(TokenType::RPAREN, "Expected ')' after condition");
+    // 'kembalikan f(...)' inside f, with nothing after the call. Turned into
+    // parameter assignments and a jump to the top of the same clone; returns
+    // false (consuming nothing) when the call resolves to another clone, or
+    // when f is @ingat (the call has to go through the cache, so it is
+    // noted in keptTailCalls instead).
+    bool generateTailCall() {
+        if (!inFunction || !check(TokenType::IDENTIFIER) || current().value != currentFunction ||
+            pos + 1 >= tokens.size() || tokens[pos + 1].type != TokenType::LPAREN) {
+            return false;
+        }
+        size_t close = pos + 1;
+        for (int depth = 0; close < tokens.size(); close++) {
+            if (tokens[close].type == TokenType::LPAREN) depth++;
+            if (tokens[close].type == TokenType::RPAREN && --depth == 0) break;
+        }
+        if (close + 1 >= tokens.size() || (tokens[close + 1].type != TokenType::NEWLINE &&
+                                            tokens[close + 1].type != TokenType::RBRACE)) {
+            return false;
+        }
         
-        emitLine("if (" + condition + ") {");
+        size_t start = pos;
+        int line = current().line;
+        advance(); // skip name
+        advance(); // skip '('
+        const FunctionInfo& info = functions.at(currentFunction);
+        std::vector<ExprResult> args;
+        while (!check(TokenType::RPAREN) && !check(TokenType::END_OF_FILE)) {
+            if (!args.empty()) {
+                expect(TokenType::COMMA, "Expected ','");
+            }
+            args.push_back(generateTypedExpression());
+        }
+        bool sameClone = args.size() == info.params.size();
+        for (size_t i = 0; sameClone && i < args.size(); i++) {
+            sameClone = resolveParamType(info, i, args[i].type) == currentParamTypes[i];
+        }
+        if (!sameClone || info.annotations.count("ingat")) {
+            if (sameClone) noteKeptTailCall(currentFunction + " (line " + std::to_string(line) + ")");
+            pos = start;
+            return false;
+        }
+        expect(TokenType::RPAREN, "Expected ')'");
         
-        expect(TokenType::LBRACE, "Expected '{' to start if body");
+        // Evaluate every argument before any parameter changes
+        emitLine("{");
         indentLevel++;
-        
-        while (!check(TokenType::RBRACE) && !check(TokenType::END_OF_FILE)) {
-            generateStatement();
+        for (size_t i = 0; i < args.size(); i++) {
+            emitLine(cTypeName(currentParamTypes[i]) + " __wear_arg" + std::to_string(i) +
+                     " = " + coerce(args[i], currentParamTypes[i]) + ";");
         }
-        
+        for (size_t i = 0; i < args.size(); i++) {
+            emitLine(info.params[i] + " = __wear_arg" + std::to_string(i) + ";");
+        }
+        emitLine("goto __wear_tail;");
         indentLevel--;
-        expect(TokenType::RBRACE, "Expected '}' to end if body");
         emitLine("}");
         
-        // Handle else
-        if (check(TokenType::LAINNYA)) {
-            advance();
-            if (check(TokenType::JIKA)) {
-                *currentOutput << indent() << "else ";
-                generateIf();
-            } else {
-                emitLine("else {");
-                expect(TokenType::LBRACE, "Expected '{' after 'lainnya'");
-                indentLevel++;
-                
-                while (!check(TokenType::RBRACE) && !check(TokenType::END_OF_FILE)) {
-                    generateStatement();
-                }
-                
-                indentLevel--;
-                expect(TokenType::RBRACE, "Expected '}' to end else body");
-                emitLine("}");
-            }
-        }
+        currentUsesTailLoop = true;
+        tailCalls.push_back(currentFunction + " (line " + std::to_string(line) + ")");
+        return true;
     }
     
-    // Generate function declaration
-    void generateFunctionDecl() {
-        advance(); // skip 'fungsi'
-        
-        std::string funcName = current().value;
-        advance(); // skip function name
-        
-        declaredFunctions.insert(funcName);
+    // ============================================================
+    // Compile-time evaluation (token-level, after inlining)
+    // ============================================================
+    
+    static const size_t foldedStringLimit = 4096;   // Longest string literal a call may fold into
+    
+    // Read a literal argument at tokens[i] (12, -12, (-12) or "text")
+    bool readLiteral(size_t& i, ConstValue& value) const {
+        bool wrapped = i + 3 < tokens.size() && tokens[i].type == TokenType::LPAREN &&
+                       tokens[i + 1].type == TokenType::MINUS && tokens[i + 2].type == TokenType::INTEGER &&
+                       tokens[i + 3].type == TokenType::RPAREN;
+        if (wrapped) i++;
+        bool negative = tokens[i].type == TokenType::MINUS;
+        if (negative) i++;
         
-        expect(TokenType::LPAREN, "Expected '(' after function name");
+        if (tokens[i].type == TokenType::INTEGER) {
+            long long number = std::strtoll(tokens[i].value.c_str(), nullptr, 10);
+            if (number > INT_MAX) return false;
+            value.number = (int)(negative ? -number : number);
+        } else if (tokens[i].type == TokenType::STRING && !negative &&
+                   decodeStringLiteral(tokens[i].value, value.text)) {
+            value.isString = true;
+        } else {
+            return false;
+        }
+        i += wrapped ? 2 : 1;
+        return true;
+    }
+    
+    // Replace calls to pure functions whose arguments are all literals with
+    // the literal they evaluate to. Scanning right to left folds inner calls
+    // first, so f(g(1)) folds completely.
+    void foldConstantCalls() {
+        // The evaluator reads function bodies from an unchanging copy
+        const std::vector<Token> original = tokens;
+        const std::unordered_map<std::string, FunctionInfo> originalFunctions = functions;
+        ConstEvaluator evaluator(original, originalFunctions, pureFunctions);
         
-        // Parse parameters
-        std::vector<std::string> params;
-        while (!check(TokenType::RPAREN) && !check(TokenType::END_OF_FILE)) {
-            if (!params.empty()) {
-                expect(TokenType::COMMA, "Expected ',' between parameters");
+        bool changed = false;
+        for (size_t i = tokens.size(); i-- > 1;) {
+            const Token& t = tokens[i];
+            if (t.type != TokenType::IDENTIFIER || !pureFunctions.count(t.value) ||
+                i + 1 >= tokens.size() || tokens[i + 1].type != TokenType::LPAREN) {
+                continue;
+            }
+            // Only calls whose value is used ('f(1)' as a statement stays)
+            TokenType before = tokens[i - 1].type;
+            if (before == TokenType::FUNGSI || before == TokenType::NEWLINE ||
+                before == TokenType::LBRACE || before == TokenType::RBRACE) {
+                continue;
             }
             
-            if (check(TokenType::IDENTIFIER)) {
-                params.push_back(current().value);
-                advance();
+            std::vector<ConstValue> args;
+            size_t j = i + 2;
+            bool literal = true;
+            while (literal && j < tokens.size() && tokens[j].type != TokenType::RPAREN) {
+                if (!args.empty()) {
+                    if (tokens[j].type != TokenType::COMMA) break;
+                    j++;
+                }
+                ConstValue arg;
+                literal = readLiteral(j, arg);
+                args.push_back(arg);
+            }
+            if (!literal || j >= tokens.size() || tokens[j].type != TokenType::RPAREN) continue;
+            
+            ConstValue result;
+            if (!evaluator.evaluate(t.value, args, result)) continue;
+            if (result.isString ? result.text.size() > foldedStringLimit : result.number == INT_MIN) continue;
+            
+            std::vector<Token> folded;
+            if (result.isString) {
+                folded.push_back(Token(TokenType::STRING, encodeStringLiteral(result.text), t.line, t.column));
+            } else if (result.number < 0) {
+                folded.push_back(Token(TokenType::LPAREN, "(", t.line, t.column));
+                folded.push_back(Token(TokenType::MINUS, "-", t.line, t.column));
+                folded.push_back(Token(TokenType::INTEGER, std::to_string(-result.number), t.line, t.column));
+                folded.push_back(Token(TokenType::RPAREN, ")", t.line, t.column));
+            } else {
+                folded.push_back(Token(TokenType::INTEGER, std::to_string(result.number), t.line, t.column));
             }
+            for (auto& f : folded) f.file = t.file;
+            
+            tokens.erase(tokens.begin() + i, tokens.begin() + j + 1);
+            tokens.insert(tokens.begin() + i, folded.begin(), folded.end());
+            changed = true;
         }
         
-        expect(TokenType::RPAREN, "Expected ')' after parameters");
-        
-        // Generate C function signature (char* params for string support)
-        std::ostringstream funcSig;
-        funcSig << "int " << funcName << "(";
-        for (size_t i = 0; i < params.size(); i++) {
-            if (i > 0) funcSig << ", ";
-            funcSig << "char* " << params[i];
+        if (changed) indexFunctions();
+    }
+    
+    // Generate return statement
+    void generateReturn() {
+        if (inParalel) {
+            std::cerr << "Error at line " << current().line
+                      << ": 'kembalikan' cannot leave a paralel loop" << std::endl;
+            std::exit(1);
         }
-        funcSig << ") {";
-        
-        // Switch to functions output
-        std::ostringstream* prevOutput = currentOutput;
-        currentOutput = &functionsOutput;
-        int prevIndent = indentLevel;
-        indentLevel = 1;
-        inFunction = true;
-        
-        functionsOutput << funcSig.str() << "\n";
-        
-        expect(TokenType::LBRACE, "Expected '{' to start function body");
+        advance(); // skip 'kembalikan'
         
-        while (!check(TokenType::RBRACE) && !check(TokenType::END_OF_FILE)) {
-            generateStatement();
+        if (inGenerator) {
+            // A generator ends; its values come from hasilkan
+            if (!check(TokenType::NEWLINE) && !check(TokenType::RBRACE)) {
+                std::cerr << "Error at line " << current().line
+                          << ": 'kembalikan' in a generator takes no value; use 'hasilkan'" << std::endl;
+                std::exit(1);
+            }
+            emitLine("__g->__state = -1;");
+            emitLine("return 0;");
+            return;
         }
         
-        expect(TokenType::RBRACE, "Expected '}' to end function body");
-        
-        functionsOutput << "}\n\n";
+        if (generateTailCall()) return;
         
-        // Switch back to main output
-        inFunction = false;
-        indentLevel = prevIndent;
-        currentOutput = prevOutput;
+        auto expr = generateTypedExpression();
+        noteReturnType(expr.type);
+        emitLine("return " + coerce(expr, currentKnownReturn) + ";");
     }
     
-    // Generate return statement
-    void generateReturn() {
-        advance(); // skip 'kembalikan'
-        
-        std::string expr = generateExpression();
-        emitLine("return " + expr + ";");
+    // Join the type of a returned (or yielded) value into the clone's
+    void noteReturnType(ExprType type) {
+        if (!inFunction || type == ExprType::UNKNOWN) return;
+        bool textual = (currentReturn == ExprType::STRING || currentReturn == ExprType::VIEW) &&
+                       (type == ExprType::STRING || type == ExprType::VIEW);
+        if (currentReturn == ExprType::UNKNOWN) {
+            currentReturn = type;
+        } else if (textual && currentReturn != type) {
+            currentReturn = ExprType::STRING;   // Views and strings: return copies
+        } else if (currentReturn != type) {
+            returnConflicts.insert(currentFunction);
+        }
     }
     
     // Generate tulis_file (write_file)
@@ -1051,7 +7947,7 @@ private:
         
         expect(TokenType::RPAREN, "Expected ')'");
         
-        emitLine("__wear_write_file(" + filename.code + ", " + content.code + ");");
+        emitLine("__wear_write_file(" + asCString(filename) + ", " + asCString(content) + ");");
     }
     
     // Generate single statement
@@ -1076,9 +7972,21 @@ private:
             case TokenType::SELAMA:
                 generateWhile();
                 break;
+            case TokenType::PARALEL:
+                generateParalel();
+                break;
+            case TokenType::UNTUK:
+                generateForEach();
+                break;
+            case TokenType::HASILKAN:
+                generateYield();
+                break;
             case TokenType::JIKA:
                 generateIf();
                 break;
+            case TokenType::ANNOTATION:
+                parseAnnotation();
+                break;
             case TokenType::FUNGSI:
                 generateFunctionDecl();
                 break;
@@ -1088,6 +7996,22 @@ private:
             case TokenType::TULIS_FILE:
                 generateWriteFile();
                 break;
+            case TokenType::URUTKAN:
+                {
+                    auto sorted = generateTypedExpression();
+                    emitLine(sorted.code + ";");
+                }
+                break;
+            case TokenType::TUNGGU:
+                {
+                    auto result = generateTypedExpression();
+                    emitLine(result.code + ";");
+                }
+                break;
+            case TokenType::JALANKAN:
+                std::cerr << "Error at line " << current().line
+                          << ": Keep the task of 'jalankan' in a variable and wait for it with 'tunggu'" << std::endl;
+                std::exit(1);
             case TokenType::BACA_FILE:
                 // baca_file as statement (result ignored)
                 {
@@ -1095,7 +8019,7 @@ private:
                     expect(TokenType::LPAREN, "Expected '('");
                     auto arg = generateTypedExpression();
                     expect(TokenType::RPAREN, "Expected ')'");
-                    emitLine("__wear_read_file(" + arg.code + ");");
+                    emitLine("__wear_read_file(" + asCString(arg) + ");");
                 }
                 break;
             case TokenType::IDENTIFIER:
@@ -1103,30 +8027,31 @@ private:
                     std::string name = current().value;
                     advance();
                     
-                    if (match(TokenType::EQUAL)) {
-                        // Assignment
+                    auto builder = builderVars.find(name);
+                    if (match(TokenType::EQUAL) && builder != builderVars.end()) {
+                        generateBuilderAppend(builder->second);
+                    } else if (tokens[pos - 1].type == TokenType::EQUAL) {
+                        // Assignment (arrays only take arrays of the same kind:
+                        // they are pointers, and 'a + b' is their joined text)
+                        int line = tokens[pos - 2].line;
                         auto expr = generateTypedExpression();
-                        emitLine(name + " = " + expr.code + ";");
-                    } else if (match(TokenType::LPAREN)) {
-                        // Function call as statement
-                        std::ostringstream call;
-                        call << name << "(";
-                        
-                        bool first = true;
-                        while (!check(TokenType::RPAREN) && !check(TokenType::END_OF_FILE)) {
-                            if (!first) {
-                                expect(TokenType::COMMA, "Expected ','");
-                                call << ", ";
-                            }
-                            first = false;
-                            auto arg = generateTypedExpression();
-                            call << arg.code;
+                        ExprType target = varType(name);
+                        if ((isArrayType(target) || isArrayType(expr.type)) && expr.type != target &&
+                            expr.type != ExprType::UNKNOWN && target != ExprType::UNKNOWN) {
+                            assignConflicts[line] = "Cannot assign " + describeType(expr.type) + " to '" + name +
+                                                    "', which holds " + describeType(target);
                         }
-                        
-                        expect(TokenType::RPAREN, "Expected ')'");
-                        call << ")";
-                        
-                        emitLine(call.str() + ";");
+                        emitLine(name + " = " + coerce(expr, target) + ";");
+                    } else if (check(TokenType::LBRACKET) && isArrayType(varType(name))) {
+                        // Element assignment 'a[i] = x'
+                        auto element = generateIndexing(ExprResult(name, varType(name)));
+                        expect(TokenType::EQUAL, "Expected '=' after array element");
+                        auto expr = generateTypedExpression();
+                        emitLine(element.code + " = " + coerce(expr, element.type) + ";");
+                    } else if (check(TokenType::LPAREN)) {
+                        // Function call as statement
+                        auto call = generateCall(name);
+                        emitLine(call.code + ";");
                     }
                 }
                 break;
@@ -1137,25 +8062,142 @@ private:
     }
 
 public:
-    explicit CodeGenerator(const std::vector<Token>& toks) : tokens(toks) {
+    explicit CodeGenerator(const std::vector<Token>& toks)
+        : own{toks, {}, {}, {}, {}}, tokens(own.tokens), functions(own.functions), knownReturns(own.knownReturns),
+          knownSpecCounts(own.knownSpecCounts), pureFunctions(own.pureFunctions) {
         currentOutput = &mainOutput;
     }
     
+    // Dead code elimination results (valid after generate())
+    const std::vector<std::string>& unusedFunctions() const { return removedFunctions; }
+    const std::vector<std::string>& unusedConstants() const { return removedConstants; }
+    bool isFileUsed(int file) const { return usedFiles.count(file) > 0; }
+    const std::vector<std::string>& convertedTailCalls() const { return tailCalls; }
+    const std::vector<std::string>& memoizedTailCalls() const { return keptTailCalls; }
+    const std::set<std::string>& uncachedMemoClones() const { return uncachedClones; }
+    
+    // Print @ingat cache hit rates when the program exits
+    void enableMemoStats() { memoStats = true; }
+    
+    // Run independent counted selama loops in parallel
+    void enableAutoParalel() { autoParalel = true; }
+    const std::map<int, std::string>& autoParalelReport() const { return autoParalelNotes; }
+    
     std::string generate() {
         std::ostringstream finalOutput;
         
-        // Generate all statements (functions go to functionsOutput, main code to mainOutput)
-        while (!check(TokenType::END_OF_FILE)) {
-            generateStatement();
+        // Collect function signatures before generating any call
+        indexFunctions();
+        
+        // Substitute small functions at their call sites (bodies calling
+        // other small functions are expanded over several rounds)
+        for (int round = 0; round < inlineRounds && inlineSmallFunctions(); round++) {
+        }
+        
+        // Calls to pure functions with literal arguments become literals
+        inferPureFunctions();
+        foldConstantCalls();
+        
+        for (const auto& name : functionOrder) {
+            if (functions[name].annotations.count("ingat") && !pureFunctions.count(name)) {
+                std::cerr << "Warning: @ingat function '" << name
+                          << "' has side effects; cached calls will skip them" << std::endl;
+            }
+        }
+        
+        // Constants only kept alive by other dead constants go in later rounds
+        while (eliminateDeadConstants()) {
+        }
+        
+        // Hoist loop-invariant pure calls and reuse repeated ones
+        optimizePureCallsEverywhere();
+        
+        // Infer return types and clones until a pass confirms the previous one
+        const int maxPasses = 16;
+        for (int passNum = 0; passNum < maxPasses; passNum++) {
+            runPass();
+            
+            std::map<std::string, ExprType> returns;
+            std::map<std::string, size_t> counts;
+            for (const auto& name : functionOrder) {
+                counts[name] = specializations[name].size();
+                for (const auto& spec : specializations[name]) {
+                    returns[name + "(" + typeKey(spec.paramTypes) + ")"] = spec.observedReturn;
+                }
+            }
+            
+            bool stable = returns == knownReturns && counts == knownSpecCounts;
+            knownReturns = returns;
+            knownSpecCounts = counts;
+            if (stable) break;
+        }
+        
+        if (!returnConflicts.empty()) {
+            for (const auto& name : returnConflicts) {
+                std::cerr << "Error: Function '" << name << "' returns both int and teks" << std::endl;
+            }
+            std::exit(1);
+        }
+        if (!assignConflicts.empty()) {
+            for (const auto& conflict : assignConflicts) {
+                std::cerr << "Error at line " << conflict.first << ": " << conflict.second << std::endl;
+            }
+            std::exit(1);
         }
         
+        collectUsage();
+        
         // Assemble final output
         finalOutput << "/* Generated by WeaR Lang Stage-0 Compiler */\n";
         
         // Inject runtime library
         finalOutput << WEAR_RUNTIME;
+        bool memoized = false;
+        for (const auto& name : functionOrder) {
+            if (functions[name].annotations.count("ingat") && !specializations[name].empty()) memoized = true;
+        }
+        if (memoized) finalOutput << WEAR_MEMO_RUNTIME;
+        if (usesSort || usesParalel || usesTasks || usesFiles) finalOutput << WEAR_POOL_RUNTIME;
+        if (usesSort) finalOutput << WEAR_SORT_RUNTIME;
+        if (usesParalel) finalOutput << WEAR_LOOP_RUNTIME;
+        if (usesTasks) finalOutput << WEAR_TASK_RUNTIME;
+        if (usesChannels) finalOutput << WEAR_CHANNEL_RUNTIME;
+        if (usesAtomics) finalOutput << WEAR_ATOMIC_RUNTIME;
+        if (usesFiles) finalOutput << WEAR_FILES_RUNTIME;
+        if (usesVector) finalOutput << WEAR_VECTOR_RUNTIME;
+        if (!scanTables.empty()) {
+            finalOutput << "// Character classes of scanning loops\n" << scanTablesOutput.str() << "\n";
+        }
+        if (!patternTables.empty()) {
+            finalOutput << "// Patterns of cocok, compiled to DFAs\n" << patternTablesOutput.str();
+        }
+        
+        // Prototypes first so functions may call each other in any order
+        if (!functionOrder.empty()) {
+            finalOutput << "// Function prototypes\n";
+            for (const auto& name : functionOrder) {
+                if (functions[name].generator) continue;
+                for (const auto& spec : specializations[name]) {
+                    finalOutput << functionSignature(functions[name], spec) << ";\n";
+                }
+            }
+            finalOutput << "\n";
+        }
+        
+        std::string generators = generatorDeclarations();
+        if (!generators.empty()) finalOutput << "// Generators\n" << generators << "\n";
+        
+        // Loop bodies outlined from paralel statements, jalankan tasks
+        if (!workersOutput.str().empty()) {
+            finalOutput << "// Bodies of paralel loops and tasks\n" << workersOutput.str();
+        }
         
         // Output functions BEFORE main
+        for (const auto& name : functionOrder) {
+            for (const auto& spec : specializations[name]) {
+                functionsOutput << spec.code;
+            }
+        }
         if (!functionsOutput.str().empty()) {
             finalOutput << "// User-defined functions\n";
             finalOutput << functionsOutput.str();
@@ -1163,6 +8205,7 @@ public:
         
         // Output main function
         finalOutput << "int main(int argc, char* argv[]) {\n";
+        if (memoized && memoStats) finalOutput << "    atexit(__wear_memo_report);\n";
         finalOutput << mainOutput.str();
         finalOutput << "\n    return 0;\n";
         finalOutput << "}\n";
@@ -1196,6 +8239,99 @@ void writeFile(const std::string& path, const std::string& content) {
     file << content;
 }
 
+// ============================================================
+// Module Loader (impor)
+// ============================================================
+
+// Splices every 'impor "file.wr"' into one token stream. Paths are relative
+// to the importing file and each file is included once.
+class ModuleLoader {
+private:
+    std::set<std::string> loaded;
+    std::map<std::string, std::vector<Token>> lexed;   // Modules read ahead, by path
+    
+    static std::string resolve(const std::string& from, const std::string& path) {
+        std::filesystem::path target = std::filesystem::path(from).parent_path() / path;
+        return std::filesystem::weakly_canonical(target).string();
+    }
+    
+    // Read and lex 'root' and every module it imports, directly or not, one
+    // level of the import graph at a time with the modules of a level on
+    // all threads. The tokens are the import scan, so exactly the modules
+    // load will splice in are read. Files that cannot be read are left to
+    // load, which reports them if (and when) it needs them.
+    void readAhead(const std::string& root) {
+        std::set<std::string> seen = {std::filesystem::weakly_canonical(root).string()};
+        std::vector<std::string> level = {root};
+        while (!level.empty()) {
+            std::vector<std::vector<Token>> tokens(level.size());
+            std::vector<char> read(level.size(), 0);
+            runParallel(level.size(), [&](size_t i) {
+                std::ifstream file(level[i]);
+                if (!file.is_open()) return;
+                std::ostringstream buffer;
+                buffer << file.rdbuf();
+                tokens[i] = Lexer(buffer.str()).tokenize();
+                read[i] = 1;
+            });
+            
+            std::vector<std::string> next;
+            for (size_t i = 0; i < level.size(); i++) {
+                if (!read[i]) continue;
+                for (size_t k = 0; k + 1 < tokens[i].size(); k++) {
+                    if (tokens[i][k].type != TokenType::IMPOR || tokens[i][k + 1].type != TokenType::STRING) continue;
+                    std::string target = resolve(level[i], tokens[i][k + 1].value);
+                    if (seen.insert(target).second) next.push_back(target);
+                }
+                lexed[level[i]] = std::move(tokens[i]);
+            }
+            level.swap(next);
+        }
+    }
+    
+public:
+    std::vector<std::string> files;  // Index = Token::file
+    
+    std::vector<Token> load(const std::string& path) {
+        if (files.empty()) readAhead(path);
+        int fileIndex = (int)files.size();
+        files.push_back(path);
+        loaded.insert(std::filesystem::weakly_canonical(path).string());
+        
+        std::vector<Token> tokens;
+        auto ahead = lexed.find(path);
+        if (ahead != lexed.end()) {
+            tokens = std::move(ahead->second);
+            lexed.erase(ahead);
+        } else {
+            tokens = Lexer(readFile(path)).tokenize();
+        }
+        
+        std::vector<Token> out;
+        for (size_t i = 0; i < tokens.size(); i++) {
+            tokens[i].file = fileIndex;
+            
+            if (tokens[i].type == TokenType::IMPOR) {
+                if (i + 1 >= tokens.size() || tokens[i + 1].type != TokenType::STRING) {
+                    std::cerr << "Error in " << path << " at line " << tokens[i].line
+                              << ": Expected file name after 'impor'" << std::endl;
+                    std::exit(1);
+                }
+                std::string target = resolve(path, tokens[i + 1].value);
+                if (!loaded.count(target)) {
+                    std::vector<Token> module = load(target);
+                    module.pop_back();  // END_OF_FILE
+                    out.insert(out.end(), module.begin(), module.end());
+                }
+                i++;  // skip file name
+                continue;
+            }
+            out.push_back(tokens[i]);
+        }
+        return out;
+    }
+};
+
 // ============================================================
 // Main Entry Point
 // ============================================================
@@ -1207,6 +8343,9 @@ void printUsage(const char* programName) {
     std::cout << "  -o <file>    Output C file (default: output.c)\n";
     std::cout << "  --compile    Compile generated C code with GCC\n";
     std::cout << "  --run        Compile and run the program\n";
+    std::cout << "  --report-tail-calls  List self tail calls turned into loops\n";
+    std::cout << "  --memo-stats         Print @ingat cache hit rates at exit\n";
+    std::cout << "  --auto-paralel       Run independent counted loops in parallel (and report why not)\n";
     std::cout << "  --help       Show this help message\n";
 }
 
@@ -1220,6 +8359,9 @@ int main(int argc, char* argv[]) {
     std::string outputFile = "output.c";
     bool compile = false;
     bool run = false;
+    bool reportTailCalls = false;
+    bool memoStats = false;
+    bool autoParalel = false;
     
     // Parse command line arguments
     for (int i = 1; i < argc; i++) {
@@ -1235,6 +8377,12 @@ int main(int argc, char* argv[]) {
         } else if (arg == "--run") {
             compile = true;
             run = true;
+        } else if (arg == "--report-tail-calls") {
+            reportTailCalls = true;
+        } else if (arg == "--memo-stats") {
+            memoStats = true;
+        } else if (arg == "--auto-paralel") {
+            autoParalel = true;
         } else if (arg[0] != '-') {
             inputFile = arg;
         }
@@ -1247,19 +8395,54 @@ int main(int argc, char* argv[]) {
     
     std::cout << "[WeaR Compiler] Reading: " << inputFile << std::endl;
     
-    // Read source file
-    std::string source = readFile(inputFile);
-    
-    // Tokenize
+    // Tokenize (imports are spliced in)
     std::cout << "[WeaR Compiler] Tokenizing..." << std::endl;
-    Lexer lexer(source);
-    std::vector<Token> tokens = lexer.tokenize();
+    ModuleLoader loader;
+    std::vector<Token> tokens = loader.load(inputFile);
     
     // Generate C code
     std::cout << "[WeaR Compiler] Generating C code..." << std::endl;
     CodeGenerator codegen(tokens);
+    if (memoStats) codegen.enableMemoStats();
+    if (autoParalel) codegen.enableAutoParalel();
     std::string cCode = codegen.generate();
     
+    // Report what dead code elimination dropped
+    for (const auto& name : codegen.unusedFunctions()) {
+        std::cout << "[WeaR Compiler] Removed unused function: " << name << std::endl;
+    }
+    for (const auto& name : codegen.unusedConstants()) {
+        std::cout << "[WeaR Compiler] Removed unused constant: " << name << std::endl;
+    }
+    for (size_t i = 1; i < loader.files.size(); i++) {
+        if (!codegen.isFileUsed((int)i)) {
+            std::cout << "[WeaR Compiler] Removed unused import: " << loader.files[i] << std::endl;
+        }
+    }
+    
+    for (const auto& clone : codegen.uncachedMemoClones()) {
+        std::cerr << "Warning: @ingat clone '" << clone
+                  << "' takes or returns an array, task, channel or atomik; its calls are not cached" << std::endl;
+    }
+    for (const auto& call : codegen.memoizedTailCalls()) {
+        std::string name = call.substr(0, call.find(' '));
+        std::cerr << "Warning: tail call " << call << " stays a call because '" << name
+                  << "' is @ingat; deep recursion may overflow the stack" << std::endl;
+    }
+    if (reportTailCalls) {
+        for (const auto& call : codegen.convertedTailCalls()) {
+            std::cout << "[WeaR Compiler] Tail call turned into loop: " << call << std::endl;
+        }
+        for (const auto& call : codegen.memoizedTailCalls()) {
+            std::cout << "[WeaR Compiler] Tail call kept as a call: " << call << ", "
+                      << call.substr(0, call.find(' ')) << " is @ingat" << std::endl;
+        }
+    }
+    
+    for (const auto& note : codegen.autoParalelReport()) {
+        std::cout << "[WeaR Compiler] Loop at line " << note.first << ": " << note.second << std::endl;
+    }
+    
     // Write output
     writeFile(outputFile, cCode);
     std::cout << "[WeaR Compiler] Generated: " << outputFile << std::endl;
@@ -1276,7 +8459,7 @@ int main(int argc, char* argv[]) {
         exeName += ".exe";
         #endif
         
-        std::string gccCmd = "gcc -O2 -o " + exeName + " " + outputFile;
+        std::string gccCmd = "gcc -O2 -pthread -o " + exeName + " " + outputFile;
         std::cout << "[WeaR Compiler] Compiling: " << gccCmd << std::endl;
         
         int result = std::system(gccCmd.c_str());
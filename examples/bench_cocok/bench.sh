@@ -0,0 +1,36 @@
+#!/bin/sh
+# Times cocok against a char_at/sama scan on the same log.
+#
+#   ./bench.sh [path/to/wearc] [lines]
+#
+# Writes log.txt (default 250000 lines, about 16 MB) with a known
+# number of ERROR lines, builds both programs and checks that each
+# prints that number. Everything it writes is removed again.
+
+set -e
+cd "$(dirname "$0")"
+trap 'rm -f log.txt hitung_cocok hitung_cocok.c hitung_manual hitung_manual.c' EXIT
+WEARC=${1:-../../archive/stage0_bootstrap/wearc}
+LINES=${2:-250000}
+
+# Every 7th line is an ERROR line; the others never contain ERROR
+awk -v n="$LINES" 'BEGIN {
+    for (i = 0; i < n; i++) {
+        if (i % 7 == 3) printf "2024-05-01 12:%02d:%02d ERROR request %d took %d ms\n", i % 60, i % 59, i, i % 997
+        else printf "2024-05-01 12:%02d:%02d INFO request %d served from cache shard %d\n", i % 60, i % 59, i, i % 13
+    }
+}' > log.txt
+EXPECTED=$(grep -c ERROR log.txt)
+
+for prog in hitung_cocok hitung_manual; do
+    "$WEARC" "$prog.wr" -o "$prog.c" > /dev/null
+    gcc -O2 -pthread -o "$prog" "$prog.c"
+    start=$(date +%s.%N)
+    got=$(./"$prog")
+    end=$(date +%s.%N)
+    if [ "$got" != "$EXPECTED" ]; then
+        echo "$prog: counted $got ERROR lines, expected $EXPECTED" >&2
+        exit 1
+    fi
+    echo "$prog: $got lines in $(awk -v a="$start" -v b="$end" "BEGIN { printf \"%.2f\", b - a }") s"
+done
@@ -0,0 +1,85 @@
+/* ============================================================
+ * urutkan runtime check (int and string arrays)
+ * WeaR has no way to build an int or teks array of millions of
+ * elements, so this drives the runtime directly: uji.sh compiles
+ * urutkan.wr to C and this file includes it, with the program's
+ * own main renamed. Every array is sorted by __wear_urutkan and by
+ * qsort, and the results must match element for element.
+ *
+ *   cek_urutkan N    (WEAR_THREADS picks the number of runs)
+ * ============================================================ */
+
+#define main __wear_program_main
+#include "urutkan.c"
+#undef main
+
+static unsigned long long __cek_state = 0x9E3779B97F4A7C15ull;
+
+static unsigned int cek_random(void) {
+    __cek_state ^= __cek_state << 13;
+    __cek_state ^= __cek_state >> 7;
+    __cek_state ^= __cek_state << 17;
+    return (unsigned int)(__cek_state >> 16);
+}
+
+static int cek_int_order(const void* a, const void* b) {
+    int x = *(const int*)a;
+    int y = *(const int*)b;
+    return x < y ? -1 : x > y;
+}
+
+static int cek_str_order(const void* a, const void* b) {
+    return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+static int cek_ints(int n) {
+    __wear_array* a = __wear_array_new(n, sizeof(int));
+    int* expected = (int*)malloc((size_t)n * sizeof(int));
+    for (int i = 0; i < n; i++) {
+        /* Full range, plus runs of repeated values */
+        int v = (int)cek_random();
+        if (i % 5 == 0) v = (int)(cek_random() % 100) - 50;
+        ((int*)a->data)[i] = expected[i] = v;
+    }
+    qsort(expected, n, sizeof(int), cek_int_order);
+    __wear_urutkan(a, 0);
+    for (int i = 0; i < n; i++) {
+        if (((int*)a->data)[i] != expected[i]) {
+            fprintf(stderr, "ints differ from qsort at %d\n", i);
+            return 1;
+        }
+    }
+    printf("ints: %d sorted like qsort\n", n);
+    return 0;
+}
+
+static int cek_strings(int n) {
+    /* Lengths 0..23 over a small alphabet, many sharing their first
+       8 bytes, so ties on the cached prefix are common */
+    char* pool = (char*)malloc((size_t)n * 24);
+    __wear_array* a = __wear_array_new(n, sizeof(char*));
+    char** expected = (char**)malloc((size_t)n * sizeof(char*));
+    for (int i = 0; i < n; i++) {
+        char* s = pool + (size_t)i * 24;
+        int len = (int)(cek_random() % 24);
+        int shared = cek_random() % 2 ? (len < 10 ? len : 10) : 0;
+        for (int k = 0; k < len; k++) s[k] = k < shared ? "kunci_ab"[k % 8] : (char)('a' + cek_random() % 6);
+        s[len] = '\0';
+        ((char**)a->data)[i] = expected[i] = s;
+    }
+    qsort(expected, n, sizeof(char*), cek_str_order);
+    __wear_urutkan(a, 1);
+    for (int i = 0; i < n; i++) {
+        if (strcmp(((char**)a->data)[i], expected[i]) != 0) {
+            fprintf(stderr, "strings differ from qsort at %d\n", i);
+            return 1;
+        }
+    }
+    printf("strings: %d sorted like qsort\n", n);
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    int n = argc > 1 ? atoi(argv[1]) : 10000000;
+    return cek_ints(n) || cek_strings(n);
+}
@@ -0,0 +1,46 @@
+#!/bin/sh
+# Checks urutkan against reference sorts on large inputs.
+#
+#   ./uji.sh [path/to/wearc] [count]
+#
+# With the default 10^7 elements, well above the 65536 at which
+# urutkan sorts on the pool:
+# - urutkan.wr sorts the lines of a generated file as views, and its
+#   output must equal 'LC_ALL=C sort';
+# - cek_urutkan.c sorts int and string arrays with the same runtime,
+#   and the results must equal qsort.
+# Each check runs with WEAR_THREADS=1 and with 16 threads. Everything
+# the script writes is removed again.
+
+set -e
+cd "$(dirname "$0")"
+WEARC=${1:-../../archive/stage0_bootstrap/wearc}
+COUNT=${2:-10000000}
+trap 'rm -f teks.txt diharapkan.txt hasil.txt urutkan urutkan.c cek_urutkan' EXIT
+
+# Lines of 1..20 letters, a third of them starting with the same 9 bytes
+awk -v n="$COUNT" 'BEGIN {
+    srand(39)
+    for (i = 0; i < n; i++) {
+        s = rand() < 0.33 ? "kunci_ab_" : ""
+        len = 1 + int(rand() * 20)
+        for (k = 0; k < len; k++) s = s substr("abcdefXYZ", 1 + int(rand() * 9), 1)
+        printf "%s%s", (i > 0 ? "\n" : ""), s
+    }
+}' > teks.txt
+LC_ALL=C sort teks.txt > diharapkan.txt
+
+"$WEARC" urutkan.wr -o urutkan.c > /dev/null
+gcc -O2 -pthread -o urutkan urutkan.c
+gcc -O2 -pthread -o cek_urutkan cek_urutkan.c
+
+for threads in 1 16; do
+    WEAR_THREADS=$threads ./urutkan > hasil.txt
+    if ! cmp -s hasil.txt diharapkan.txt; then
+        echo "views, WEAR_THREADS=$threads: output differs from sort" >&2
+        exit 1
+    fi
+    echo "WEAR_THREADS=$threads: views: $COUNT lines sorted like sort"
+    checked=$(WEAR_THREADS=$threads ./cek_urutkan "$COUNT")
+    echo "$checked" | sed "s/^/WEAR_THREADS=$threads: /"
+done
@@ -94,6 +94,20 @@ int __wear_strlen(const char* s) {
     return (int)strlen(s);
 }
 
+/* Length of the most recently indexed string.
+ * WeaR strings are immutable, so scanners that index the same source
+ * over and over only pay for strlen once instead of once per character. */
+static const char* __wear_len_cache_str = NULL;
+static int __wear_len_cache_len = 0;
+
+int __wear_cached_len(const char* s) {
+    if (s != __wear_len_cache_str) {
+        __wear_len_cache_str = s;
+        __wear_len_cache_len = (int)strlen(s);
+    }
+    return __wear_len_cache_len;
+}
+
 /* Character at index (returns 1-char string) */
 char* __wear_char_at(const char* s, int index) {
     char* result = (char*)malloc(2);
@@ -101,7 +115,7 @@ char* __wear_char_at(const char* s, int index) {
         fprintf(stderr, "Error: Memory allocation failed\n");
         exit(1);
     }
-    if (index >= 0 && index < (int)strlen(s)) {
+    if (index >= 0 && index < __wear_cached_len(s)) {
         result[0] = s[index];
         result[1] = '\0';
     } else {
@@ -110,6 +124,32 @@ char* __wear_char_at(const char* s, int index) {
     return result;
 }
 
+/* Byte at index as an int (0 when out of range), no allocation */
+int __wear_kode_at(const char* s, int index) {
+    if (index < 0 || index >= __wear_cached_len(s)) return 0;
+    return (unsigned char)s[index];
+}
+
+/* Character class lookup table: bit 1 = digit, bit 2 = letter (A-Z, a-z, _) */
+#define __WEAR_CLASS_DIGIT  1
+#define __WEAR_CLASS_LETTER 2
+static const unsigned char __wear_char_class[256] = {
+    ['0' ... '9'] = __WEAR_CLASS_DIGIT,
+    ['A' ... 'Z'] = __WEAR_CLASS_LETTER,
+    ['a' ... 'z'] = __WEAR_CLASS_LETTER,
+    ['_'] = __WEAR_CLASS_LETTER
+};
+
+/* Check if byte code is a digit (returns 1 if digit, 0 otherwise) */
+int __wear_is_digit_kode(int code) {
+    return (__wear_char_class[code & 0xFF] & __WEAR_CLASS_DIGIT) ? 1 : 0;
+}
+
+/* Check if byte code is a letter or underscore (returns 1 if letter, 0 otherwise) */
+int __wear_is_letter_kode(int code) {
+    return (__wear_char_class[code & 0xFF] & __WEAR_CLASS_LETTER) ? 1 : 0;
+}
+
 /* Check if character is a quote (returns 1 if quote, 0 otherwise) */
 int __wear_is_quote(const char* s) {
     if (s == NULL || s[0] == '\0') return 0;